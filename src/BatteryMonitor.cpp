@@ -1,4 +1,8 @@
 #include "BatteryMonitor.h"
+#include "ConfigManager.h"
+#include "PowerManager.h"
+
+//#define DEBUG
 
 sensor::BatteryMonitor *sensor::BatteryMonitor::m_instance = nullptr;
 
@@ -11,7 +15,11 @@ sensor::BatteryMonitor *sensor::BatteryMonitor::getInstance()
 	return m_instance;
 }
 
-sensor::BatteryMonitor::BatteryMonitor() {}
+sensor::BatteryMonitor::BatteryMonitor()
+{
+	m_voltage_pin = 0;
+	m_reading = 0;
+}
 
 // Sets the internal voltage pin variable and initiazes that pin
 // as an input.
@@ -25,11 +33,22 @@ void sensor::BatteryMonitor::init(uint8_t voltage_pin)
 // Returns true if the battery is bellow the threshold and true otherwise.
 bool sensor::BatteryMonitor::isLow()
 {
+	PowerManager::getInstance()->claim(domain_adc);
 	uint16_t battery_voltage = analogRead(m_voltage_pin);
+	PowerManager::getInstance()->release(domain_adc);
+	m_reading = battery_voltage;
+#ifdef DEBUG
 	Serial.println("Battery: " + String(battery_voltage));
-	if (battery_voltage <= battery_voltage_threshold)
+#endif
+	if (battery_voltage <= ConfigManager::getInstance()->get().battery_voltage_threshold)
 	{
 		return true;
 	}
 	return false;
+}
+
+// Returns the analog reading of the last check.
+uint16_t sensor::BatteryMonitor::getReading()
+{
+	return m_reading;
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ Encapsulates the fuctions for the battery readings.
 namespace sensor
 {
 	// Minimum analog read for a healthy battery charge
-	// for a 6V battery pack
+	// for a 6V battery pack, default of the remote configuration
 	const uint16_t battery_voltage_threshold = 617;
 
 	class BatteryMonitor
@@ -25,6 +25,7 @@ namespace sensor
 		static BatteryMonitor *getInstance();
 		void init(uint8_t voltage_pin);
 		bool isLow();
+		uint16_t getReading();
 
 	private:
 		// Methods
@@ -32,5 +33,6 @@ namespace sensor
 		// Variables
 		static BatteryMonitor *m_instance;
 		uint8_t m_voltage_pin;
+		uint16_t m_reading; // Analog reading of the last check
 	};
 } // namespace sensor
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "ChannelManager.h"
+#include "ConfigManager.h"
+#include "EventLog.h"
+#include "RadioManager.h"
+
+sensor::ChannelManager *sensor::ChannelManager::m_instance = nullptr;
+
+sensor::ChannelManager *sensor::ChannelManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new ChannelManager();
+	}
+	return m_instance;
+}
+
+sensor::ChannelManager::ChannelManager()
+{
+	m_count = 0;
+	m_channel = 0;
+	m_failures = 0;
+}
+
+// Starts on the rendezvous channel, the radio is initialized on it.
+void sensor::ChannelManager::init()
+{
+	m_channel = ConfigManager::getInstance()->get().channel;
+	m_failures = 0;
+}
+
+// Counts a message sent on the current channel. Once the hub is lost on a
+// hopped channel, the sensor returns to the rendezvous channel.
+void sensor::ChannelManager::onSend(bool sent, uint8_t writes)
+{
+	diagnostics::ChannelStats &stats = statsOf(m_channel);
+	stats.messages++;
+	stats.writes += writes;
+	if (sent)
+	{
+		stats.delivered++;
+		m_failures = 0;
+		return;
+	}
+
+	m_failures++;
+	if (m_failures >= rendezvous_failures)
+	{
+		rendezvous();
+	}
+}
+
+// Moves to the channel announced by the hub, 0 keeps the current one. Channels
+// outside the hop set are ignored.
+void sensor::ChannelManager::follow(uint8_t channel)
+{
+	if (channel == 0 || !isHopChannel(channel))
+	{
+		return;
+	}
+	moveTo(channel);
+}
+
+// Returns to the rendezvous channel, also used before install mode as the
+// hub takes join requests there.
+void sensor::ChannelManager::rendezvous()
+{
+	moveTo(ConfigManager::getInstance()->get().channel);
+}
+
+uint8_t sensor::ChannelManager::getChannel()
+{
+	return m_channel;
+}
+
+// Returns the statistics of the tracked channels. Also called from the I2C
+// interrupt, while the main loop waits in install mode.
+diagnostics::ChannelReport sensor::ChannelManager::getReport()
+{
+	diagnostics::ChannelReport report;
+	report.count = m_count;
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		report.channels[i] = m_stats[i];
+	}
+	return report;
+}
+
+// Returns whether the channel is the rendezvous channel or one of the hop set.
+bool sensor::ChannelManager::isHopChannel(uint8_t channel)
+{
+	const sensortypes::SensorConfig &config = ConfigManager::getInstance()->get();
+	if (channel == config.channel)
+	{
+		return true;
+	}
+	for (uint8_t i = 0; i < sensortypes::max_hop_channels; i++)
+	{
+		if (config.hop_channels[i] == channel)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void sensor::ChannelManager::moveTo(uint8_t channel)
+{
+	m_failures = 0;
+	if (channel == m_channel)
+	{
+		return;
+	}
+	m_channel = channel;
+	RadioManager::getInstance()->setChannel(channel);
+	EventLog::getInstance()->log(eventlog::event_channel, channel);
+}
+
+// Returns the statistics of the channel, replacing the entry with the fewest messages when full.
+diagnostics::ChannelStats &sensor::ChannelManager::statsOf(uint8_t channel)
+{
+	uint8_t least_used = 0;
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		if (m_stats[i].channel == channel)
+		{
+			return m_stats[i];
+		}
+		if (m_stats[i].messages < m_stats[least_used].messages)
+		{
+			least_used = i;
+		}
+	}
+
+	uint8_t index = m_count < max_tracked_channels ? m_count++ : least_used;
+	m_stats[index] = diagnostics::ChannelStats();
+	m_stats[index].channel = channel;
+	return m_stats[index];
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+/*
+Follows the channel the hub hops to, announced in the ack payload, and keeps
+delivery statistics of every channel used, which the hub reads over I2C in
+install mode. The configured channel is the rendezvous: the sensor starts on
+it and returns to it once it loses the hub on a hopped channel, where the hub
+keeps listening for sensors out of sync. Only the channels of the configured
+hop set are followed, so a corrupted or foreign announcement cannot move the
+sensor off the hub's channels.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "common/diagnostics.h"
+
+namespace sensor
+{
+	// Failed messages in a row after which the sensor returns to the rendezvous channel
+	const uint8_t rendezvous_failures = 3;
+	// Channels with statistics, the least used entry is replaced when full
+	const uint8_t max_tracked_channels = diagnostics::report_channels;
+
+	class ChannelManager
+	{
+	public:
+		ChannelManager(ChannelManager const &) = delete;
+		void operator=(ChannelManager const &) = delete;
+		// Methods
+		static ChannelManager *getInstance();
+		void init();
+		void onSend(bool sent, uint8_t writes);
+		void follow(uint8_t channel);
+		void rendezvous();
+		uint8_t getChannel();
+		diagnostics::ChannelReport getReport();
+
+	private:
+		// Methods
+		ChannelManager();
+		bool isHopChannel(uint8_t channel);
+		void moveTo(uint8_t channel);
+		diagnostics::ChannelStats &statsOf(uint8_t channel);
+		// Variables
+		static ChannelManager *m_instance;
+		diagnostics::ChannelStats m_stats[max_tracked_channels];
+		uint8_t m_count;
+		uint8_t m_channel;
+		uint8_t m_failures; // Failed messages in a row on the current channel
+	};
+} // namespace sensor
\ No newline at end of file
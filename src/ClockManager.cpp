@@ -0,0 +1,42 @@
+#include "ClockManager.h"
+
+sensor::ClockManager *sensor::ClockManager::m_instance = nullptr;
+
+sensor::ClockManager *sensor::ClockManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new ClockManager();
+	}
+	return m_instance;
+}
+
+// The mcu boots at the full clock.
+sensor::ClockManager::ClockManager()
+{
+	m_is_full_speed = true;
+}
+
+// Switches between the full and the housekeeping clock. The prescaler change needs
+// the timed sequence of the datasheet, so interrupts are kept out while it runs.
+void sensor::ClockManager::setFullSpeed(bool is_full_speed)
+{
+	if (is_full_speed == m_is_full_speed)
+	{
+		return;
+	}
+
+	uint8_t sreg = SREG;
+	noInterrupts();
+	CLKPR = _BV(CLKPCE);
+	CLKPR = is_full_speed ? 0 : housekeeping_clock_prescaler;
+	TCCR0B = (TCCR0B & ~timer0_prescaler_mask) | (is_full_speed ? full_timer0_prescaler : housekeeping_timer0_prescaler);
+	SREG = sreg;
+	m_is_full_speed = is_full_speed;
+}
+
+// Returns true if the mcu runs at the full clock.
+bool sensor::ClockManager::isFullSpeed()
+{
+	return m_is_full_speed;
+}
\ No newline at end of file
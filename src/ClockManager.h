@@ -0,0 +1,42 @@
+/*
+Scales the system clock with the clock prescaler. Housekeeping between wakeups
+runs at a low clock and the full clock is restored only while a peripheral that
+depends on it is in use, see PowerManager. Timer 0 is prescaled the opposite way,
+so millis, micros and delay keep their time at both speeds.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+namespace sensor
+{
+	// Housekeeping clock is 8MHz / 8 = 1MHz, timer 0 then counts every
+	// cycle / 8 instead of / 64, which is the same 125KHz tick.
+	const uint8_t housekeeping_clock_prescaler = _BV(CLKPS1) | _BV(CLKPS0);
+	const uint8_t housekeeping_timer0_prescaler = _BV(CS01);
+	const uint8_t full_timer0_prescaler = _BV(CS01) | _BV(CS00);
+	const uint8_t timer0_prescaler_mask = _BV(CS02) | _BV(CS01) | _BV(CS00);
+
+	class ClockManager
+	{
+	public:
+		ClockManager(ClockManager const &) = delete;
+		void operator=(ClockManager const &) = delete;
+		// Methods
+		static ClockManager *getInstance();
+		void setFullSpeed(bool is_full_speed);
+		bool isFullSpeed();
+
+	private:
+		// Methods
+		ClockManager();
+		// Variables
+		static ClockManager *m_instance;
+		bool m_is_full_speed;
+	};
+} // namespace sensor
\ No newline at end of file
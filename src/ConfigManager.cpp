@@ -0,0 +1,133 @@
+#include "ConfigManager.h"
+#include "BatteryMonitor.h"
+#include "RadioManager.h"
+#include "SavedData.h"
+
+sensor::ConfigManager *sensor::ConfigManager::m_instance = nullptr;
+
+sensor::ConfigManager *sensor::ConfigManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new ConfigManager();
+	}
+	return m_instance;
+}
+
+sensor::ConfigManager::ConfigManager()
+{
+	m_config.version = 0;
+	m_config.battery_voltage_threshold = battery_voltage_threshold;
+	m_config.sleep_cycles_armed = sleep_cycles_armed;
+	m_config.led_interval = led_interval;
+	m_config.max_retries = max_retries;
+	m_config.min_delay = min_delay;
+	m_config.max_delay = max_delay;
+	m_config.channel = channel;
+}
+
+// Loads the saved configuration, the defaults are kept if none was saved.
+void sensor::ConfigManager::init()
+{
+	SavedData::getInstance()->readConfig(m_config);
+}
+
+// Returns the configuration currently in use.
+const sensortypes::SensorConfig &sensor::ConfigManager::get()
+{
+	return m_config;
+}
+
+// Applies a configuration table received from the hub and saves the result under
+// the given version. The whole table is rejected if any entry is malformed or the
+// resulting values are not usable, so a bad push cannot leave the sensor half configured.
+bool sensor::ConfigManager::apply(uint8_t version, const uint8_t *table, uint8_t length)
+{
+	sensortypes::SensorConfig config = m_config;
+	uint8_t index = 0;
+	while (index + 1 < length && table[index] != sensortypes::config_end)
+	{
+		uint8_t tag = table[index];
+		uint8_t value_length = table[index + 1];
+		index += 2;
+		if (index + value_length > length || !applyEntry(config, tag, &table[index], value_length))
+		{
+			return false;
+		}
+		index += value_length;
+	}
+
+	// A tag in the last byte has no room for its length, the table was cut short
+	if (index + 1 == length && table[index] != sensortypes::config_end)
+	{
+		return false;
+	}
+
+	if (config.sleep_cycles_armed == 0 || config.min_delay > config.max_delay || config.max_retries == 0)
+	{
+		return false;
+	}
+
+	config.version = version;
+	m_config = config;
+	SavedData::getInstance()->saveConfig(m_config);
+	return true;
+}
+
+// Copies a single entry value to the matching field. Entries with an unknown
+// tag are skipped, so newer hubs can talk to older sensors.
+bool sensor::ConfigManager::applyEntry(sensortypes::SensorConfig &config, uint8_t tag, const uint8_t *value, uint8_t length)
+{
+	uint16_t number = 0;
+	if (length == 1)
+	{
+		number = value[0];
+	}
+	else if (length == 2)
+	{
+		number = value[0] | (value[1] << 8);
+	}
+	switch (tag)
+	{
+	case sensortypes::config_battery_threshold:
+		config.battery_voltage_threshold = number;
+		return length == 2;
+	case sensortypes::config_sleep_cycles_armed:
+		config.sleep_cycles_armed = number;
+		return length == 1;
+	case sensortypes::config_led_interval:
+		config.led_interval = number;
+		return length == 2;
+	case sensortypes::config_max_retries:
+		config.max_retries = number;
+		return length == 1;
+	case sensortypes::config_min_delay:
+		config.min_delay = number;
+		return length == 2;
+	case sensortypes::config_max_delay:
+		config.max_delay = number;
+		return length == 2;
+	case sensortypes::config_channel:
+		config.channel = number;
+		return length == 1 && number <= 125;
+	case sensortypes::config_hop_channels:
+		if (length > sensortypes::max_hop_channels)
+		{
+			return false;
+		}
+		for (uint8_t i = 0; i < sensortypes::max_hop_channels; i++)
+		{
+			config.hop_channels[i] = i < length ? value[i] : 0;
+			if (config.hop_channels[i] > 125)
+			{
+				return false;
+			}
+		}
+		return true;
+	case sensortypes::config_relay:
+		config.relay = number;
+		return length == 1 && number <= 1;
+	default:
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+Holds the thresholds and timings of the sensor in RAM. They start from the
+compile time defaults, can be replaced by the hub through configuration
+tables in the ack payload and are persisted in the EEPROM.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "common/sensortypes.h"
+
+namespace sensor
+{
+	// Defaults of the values that have no module of their own
+	const uint8_t sleep_cycles_armed = 24;
+	const uint16_t led_interval = 200;
+
+	class ConfigManager
+	{
+	public:
+		ConfigManager(ConfigManager const &) = delete;
+		void operator=(ConfigManager const &) = delete;
+		// Methods
+		static ConfigManager *getInstance();
+		void init();
+		const sensortypes::SensorConfig &get();
+		bool apply(uint8_t version, const uint8_t *table, uint8_t length);
+
+	private:
+		// Methods
+		ConfigManager();
+		bool applyEntry(sensortypes::SensorConfig &config, uint8_t tag, const uint8_t *value, uint8_t length);
+		// Variables
+		static ConfigManager *m_instance;
+		sensortypes::SensorConfig m_config;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "DeliveryPolicy.h"
+
+sensor::DeliveryPolicy *sensor::DeliveryPolicy::m_instance = nullptr;
+
+sensor::DeliveryPolicy *sensor::DeliveryPolicy::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new DeliveryPolicy();
+	}
+	return m_instance;
+}
+
+sensor::DeliveryPolicy::DeliveryPolicy()
+{
+	m_pending = false;
+	m_dropped = false;
+	m_round = 0;
+	m_elapsed = 0;
+	m_writes = 0;
+}
+
+// Returns the seconds slept after the given failed round, counted from 0. The
+// schedule is public so it can be checked without running the radio.
+uint8_t sensor::DeliveryPolicy::getScheduledDelay(uint8_t round)
+{
+	if (round >= retry_schedule_length)
+	{
+		round = retry_schedule_length - 1;
+	}
+	return retry_schedule[round];
+}
+
+// Starts tracking a new event, with a fresh deadline and budget.
+void sensor::DeliveryPolicy::start()
+{
+	m_pending = true;
+	m_dropped = false;
+	m_round = 0;
+	m_elapsed = 0;
+	m_writes = 0;
+}
+
+// Continues tracking an event that was pending before a reset, with the deadline
+// and budget it had left.
+void sensor::DeliveryPolicy::resume(uint8_t round, uint16_t elapsed, uint16_t writes)
+{
+	m_pending = true;
+	m_dropped = false;
+	m_round = round;
+	m_elapsed = elapsed;
+	m_writes = writes;
+}
+
+// Records the outcome of a round. A delivered event stops pending, a failed one
+// stays pending for the next round unless its deadline or budget is spent.
+void sensor::DeliveryPolicy::onAttempt(bool sent, uint8_t writes)
+{
+	if (!m_pending)
+	{
+		return;
+	}
+
+	if (sent)
+	{
+		m_pending = false;
+		return;
+	}
+
+	// The round counter stops growing once the schedule repeats its last delay
+	if (m_round < retry_schedule_length)
+	{
+		m_round++;
+	}
+	m_writes += writes;
+	m_elapsed += getRetryDelay();
+
+	if (m_elapsed >= event_deadline || m_writes >= event_write_budget)
+	{
+		m_pending = false;
+		m_dropped = true;
+	}
+}
+
+// Returns true while an event waits to be delivered.
+bool sensor::DeliveryPolicy::isPending()
+{
+	return m_pending;
+}
+
+// Returns true if the last event was given up.
+bool sensor::DeliveryPolicy::wasDropped()
+{
+	return m_dropped;
+}
+
+// Returns the seconds to sleep before the next round.
+uint8_t sensor::DeliveryPolicy::getRetryDelay()
+{
+	return getScheduledDelay(m_round > 0 ? m_round - 1 : 0);
+}
+
+// Returns the failed rounds of the pending event.
+uint8_t sensor::DeliveryPolicy::getRound()
+{
+	return m_round;
+}
+
+// Returns the seconds the pending event waited for its retries.
+uint16_t sensor::DeliveryPolicy::getElapsed()
+{
+	return m_elapsed;
+}
+
+// Returns the writes the pending event spent.
+uint16_t sensor::DeliveryPolicy::getWrites()
+{
+	return m_writes;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+/*
+Keeps a triggered event pending until it is delivered, spreading the retry
+rounds over sleep periods of increasing length. The event is dropped once its
+deadline passes or its write budget is spent, so a hub outage cannot drain
+the battery.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+namespace sensor
+{
+	// Seconds slept before each retry round of a pending event, the last one repeats
+	const uint8_t retry_schedule[] = {1, 2, 4, 8, 16, 32, 64};
+	const uint8_t retry_schedule_length = sizeof(retry_schedule) / sizeof(retry_schedule[0]);
+	// Seconds after which an undelivered event is dropped
+	const uint16_t event_deadline = 600;
+	// Full power writes an event may spend, about 10 rounds of max_retries
+	const uint16_t event_write_budget = 160;
+
+	class DeliveryPolicy
+	{
+	public:
+		DeliveryPolicy(DeliveryPolicy const &) = delete;
+		void operator=(DeliveryPolicy const &) = delete;
+		// Methods
+		static DeliveryPolicy *getInstance();
+		static uint8_t getScheduledDelay(uint8_t round);
+		void start();
+		void resume(uint8_t round, uint16_t elapsed, uint16_t writes);
+		void onAttempt(bool sent, uint8_t writes);
+		bool isPending();
+		bool wasDropped();
+		uint8_t getRetryDelay();
+		uint8_t getRound();
+		uint16_t getElapsed();
+		uint16_t getWrites();
+
+	private:
+		// Methods
+		DeliveryPolicy();
+		// Variables
+		static DeliveryPolicy *m_instance;
+		bool m_pending;
+		bool m_dropped;
+		uint8_t m_round;
+		uint16_t m_elapsed;
+		uint16_t m_writes;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "EventLog.h"
+
+sensor::EventLog *sensor::EventLog::m_instance = nullptr;
+
+sensor::EventLog *sensor::EventLog::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new EventLog();
+	}
+	return m_instance;
+}
+
+sensor::EventLog::EventLog()
+{
+	m_batched = 0;
+	m_head = 0;
+	m_count = 0;
+	m_sequence = 0;
+	m_slept = 0;
+	m_slept_millis = 0;
+}
+
+// Erases the log the first time the controller boots with it, then finds the end
+// of the ring, the first record that is erased or does not follow the one before.
+void sensor::EventLog::init()
+{
+	if (EEPROM.read(log_cookie_address) != log_cookie_value)
+	{
+		for (uint8_t i = 0; i < log_capacity; i++)
+		{
+			EEPROM.update(log_address + i * eventlog::log_record_size + 1, eventlog::event_empty);
+		}
+		EEPROM.write(log_cookie_address, log_cookie_value);
+	}
+
+	m_head = 0;
+	m_count = log_capacity;
+	for (uint8_t i = 0; i < log_capacity; i++)
+	{
+		uint16_t address = log_address + i * eventlog::log_record_size;
+		if (EEPROM.read(address + 1) == eventlog::event_empty)
+		{
+			m_head = i;
+			m_count = i;
+			break;
+		}
+		uint8_t sequence = EEPROM.read(address);
+		if (i > 0 && sequence != (uint8_t)(m_sequence + 1))
+		{
+			m_head = i;
+			break;
+		}
+		m_sequence = sequence;
+	}
+	m_sequence++;
+}
+
+// Adds a record to the batch, the batch is written once it is full or with an
+// urgent record.
+void sensor::EventLog::log(eventlog::log_event_t event, uint16_t value)
+{
+	eventlog::LogRecord &record = m_batch[m_batched];
+	record.sequence = m_sequence++;
+	record.event = event;
+	record.value = value;
+	record.time = m_slept + millis() / 1000;
+	m_batched++;
+	if (m_batched == log_batch_size || isUrgent(event))
+	{
+		flush();
+	}
+}
+
+// Writes the batched records to the ring, overwriting the oldest ones.
+void sensor::EventLog::flush()
+{
+	for (uint8_t i = 0; i < m_batched; i++)
+	{
+		EEPROM.put(log_address + m_head * eventlog::log_record_size, m_batch[i]);
+		m_head = (m_head + 1) % log_capacity;
+		if (m_count < log_capacity)
+		{
+			m_count++;
+		}
+	}
+	m_batched = 0;
+}
+
+// Returns whether the records of the event must reach the EEPROM before the next
+// reset, the ones that explain a missed alarm.
+bool sensor::EventLog::isUrgent(eventlog::log_event_t event)
+{
+	return event == eventlog::event_reset || event == eventlog::event_trigger || event == eventlog::event_dropped;
+}
+
+// Adds the time spent in power down, where millis() stops.
+void sensor::EventLog::addSleep(uint16_t milliseconds)
+{
+	m_slept_millis += milliseconds;
+	m_slept += m_slept_millis / 1000;
+	m_slept_millis %= 1000;
+}
+
+// Returns the size of the dump of the written records, with its header.
+uint16_t sensor::EventLog::getDumpSize()
+{
+	return eventlog::dump_header_size + m_count * eventlog::log_record_size;
+}
+
+// Copies the bytes of the dump from the offset into the buffer, returns the bytes
+// copied. Only reads the EEPROM, so it is safe to call from the I2C interrupt.
+uint8_t sensor::EventLog::readDump(uint16_t offset, uint8_t *buffer, uint8_t length)
+{
+	const uint8_t header[eventlog::dump_header_size] = {eventlog::dump_magic, eventlog::log_record_size, m_count};
+	uint8_t oldest = m_count < log_capacity ? 0 : m_head;
+	uint8_t copied = 0;
+	while (copied < length && offset < getDumpSize())
+	{
+		if (offset < eventlog::dump_header_size)
+		{
+			buffer[copied] = header[offset];
+		}
+		else
+		{
+			uint16_t position = offset - eventlog::dump_header_size;
+			uint8_t index = (oldest + position / eventlog::log_record_size) % log_capacity;
+			buffer[copied] = EEPROM.read(log_address + index * eventlog::log_record_size + position % eventlog::log_record_size);
+		}
+		copied++;
+		offset++;
+	}
+	return copied;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+Keeps a ring log of recent events in the EEPROM, so a missed alarm can be
+traced back on the sensor (see common/eventlog.h). Records of the frequent
+events are batched in RAM and written together, which limits the wear of the
+EEPROM and the wakes spent writing it. Records that explain a missed alarm,
+the resets, triggers and dropped events, are written at once with the batch
+before them, since the resets they diagnose lose whatever is still batched.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <EEPROM.h>
+#include "common/eventlog.h"
+
+namespace sensor
+{
+	// The log lives after the memory init cookie, behind its own cookie
+	const uint16_t log_cookie_address = 513;
+	const uint8_t log_cookie_value = 0x4C;
+	const uint16_t log_address = 520;
+	// Records in the ring, below 128 so the sequence finds the end of the ring
+	const uint8_t log_capacity = (1024 - log_address) / eventlog::log_record_size;
+	// Records written to the EEPROM together
+	const uint8_t log_batch_size = 4;
+
+	class EventLog
+	{
+	public:
+		EventLog(EventLog const &) = delete;
+		void operator=(EventLog const &) = delete;
+		// Methods
+		static EventLog *getInstance();
+		void init();
+		void log(eventlog::log_event_t event, uint16_t value);
+		void flush();
+		static bool isUrgent(eventlog::log_event_t event);
+		void addSleep(uint16_t milliseconds);
+		uint16_t getDumpSize();
+		uint8_t readDump(uint16_t offset, uint8_t *buffer, uint8_t length);
+
+	private:
+		// Methods
+		EventLog();
+		// Variables
+		static EventLog *m_instance;
+		eventlog::LogRecord m_batch[log_batch_size];
+		uint8_t m_batched;
+		uint8_t m_head;	 // Record written next
+		uint8_t m_count; // Records in the ring
+		uint8_t m_sequence;
+		uint32_t m_slept;		 // Seconds slept since boot
+		uint16_t m_slept_millis; // Milliseconds slept on top of the seconds
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "FirmwareUpdater.h"
+#include "RadioManager.h"
+#include "SpiFlash.h"
+#include "common/Timer.h"
+#include <avr/wdt.h>
+#include <util/crc16.h>
+
+sensor::FirmwareUpdater *sensor::FirmwareUpdater::m_instance = nullptr;
+
+sensor::FirmwareUpdater *sensor::FirmwareUpdater::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new FirmwareUpdater();
+	}
+	return m_instance;
+}
+
+sensor::FirmwareUpdater::FirmwareUpdater() {}
+
+// Initializes the flash that stages the images.
+void sensor::FirmwareUpdater::init(uint8_t flash_cs_pin)
+{
+	SpiFlash::getInstance()->init(flash_cs_pin);
+}
+
+// Receives the header and the chunks of an image, acking each window. Restarts into the
+// bootloader if the image is verified, else returns false, leaving the running firmware untouched.
+bool sensor::FirmwareUpdater::update()
+{
+	RadioManager *radio = RadioManager::getInstance();
+	SpiFlash *flash = SpiFlash::getInstance();
+	sensortypes::FirmwareHeader header;
+	sensortypes::FirmwareChunk chunk;
+	Timer idle_timer(firmware_idle_timeout);
+	bool has_header = false;
+	uint16_t base = 0;
+	uint8_t received = 0;
+	uint32_t last_chunk = millis();
+
+	flash->wake();
+	radio->startReceiving();
+	while (!idle_timer.timeout())
+	{
+		uint8_t size = radio->receive(&chunk, sizeof(chunk));
+		if (size == 0)
+		{
+			// Once the hub stops sending, ack the incomplete window so only the gaps are resent
+			if (received != 0 && millis() - last_chunk > firmware_window_timeout)
+			{
+				sendWindowAck(base, received, sensortypes::firmware_receiving);
+				last_chunk = millis();
+			}
+			continue;
+		}
+		idle_timer.reset();
+		last_chunk = millis();
+
+		// The header is resent until acked, the flash is only erased the first time
+		if (chunk.index == sensortypes::firmware_header_index)
+		{
+			if (!has_header)
+			{
+				memcpy(&header, chunk.data, sizeof(header));
+				uint16_t chunk_count = (header.image_size + sensortypes::firmware_chunk_size - 1) / sensortypes::firmware_chunk_size;
+				if (header.image_size == 0 || header.image_size > max_image_size || header.chunk_count != chunk_count)
+				{
+					sendWindowAck(sensortypes::firmware_header_index, 0, sensortypes::firmware_failed);
+					break;
+				}
+				flash->eraseSectors(0, image_header_length + header.image_size);
+				has_header = true;
+			}
+			sendWindowAck(sensortypes::firmware_header_index, 1, sensortypes::firmware_receiving);
+			continue;
+		}
+
+		if (!has_header || chunk.index >= header.chunk_count)
+		{
+			continue;
+		}
+
+		// A chunk of an already completed window means its ack was lost, repeat it
+		if (chunk.index < base)
+		{
+			sendWindowAck(base - sensortypes::firmware_window_size, 0xFF, sensortypes::firmware_receiving);
+			continue;
+		}
+
+		uint8_t window_chunks = min(sensortypes::firmware_window_size, header.chunk_count - base);
+		if (chunk.index >= base + window_chunks)
+		{
+			continue;
+		}
+
+		// Store the chunk, the last one of the image is shorter
+		uint8_t chunk_bit = 1 << (chunk.index - base);
+		if (!(received & chunk_bit))
+		{
+			uint16_t offset = chunk.index * sensortypes::firmware_chunk_size;
+			uint8_t length = min(sensortypes::firmware_chunk_size, header.image_size - offset);
+			flash->write(image_header_length + offset, chunk.data, length);
+			received |= chunk_bit;
+		}
+
+		// Move to the next window once all of its chunks are stored
+		uint8_t window_mask = (1 << window_chunks) - 1;
+		if (received == window_mask)
+		{
+			sendWindowAck(base, received, sensortypes::firmware_receiving);
+			base += window_chunks;
+			received = 0;
+		}
+
+		if (base >= header.chunk_count)
+		{
+			bool is_verified = verify(header);
+			sendWindowAck(base, 0, is_verified ? sensortypes::firmware_verified : sensortypes::firmware_failed);
+			if (is_verified)
+			{
+				restart(header);
+			}
+			break;
+		}
+	}
+
+	radio->stopReceiving();
+	flash->sleep();
+	return false;
+}
+
+// Reads the staged image back and compares its crc with the one of the header.
+bool sensor::FirmwareUpdater::verify(const sensortypes::FirmwareHeader &header)
+{
+	uint8_t buffer[32];
+	uint16_t crc = 0;
+	for (uint16_t offset = 0; offset < header.image_size; offset += sizeof(buffer))
+	{
+		uint8_t length = min(sizeof(buffer), header.image_size - offset);
+		SpiFlash::getInstance()->read(image_header_length + offset, buffer, length);
+		for (uint8_t i = 0; i < length; i++)
+		{
+			crc = _crc_xmodem_update(crc, buffer[i]);
+		}
+	}
+	return crc == header.crc;
+}
+
+// Reports the chunks of a window that were stored.
+void sensor::FirmwareUpdater::sendWindowAck(uint16_t base, uint8_t received, sensortypes::firmware_status_t status)
+{
+	sensortypes::FirmwareWindowAck ack;
+	ack.base = base;
+	ack.received = received;
+	ack.status = status;
+	RadioManager::getInstance()->transmit(&ack, sizeof(ack));
+}
+
+// Marks the staged image as valid for the bootloader and resets through the watchdog.
+void sensor::FirmwareUpdater::restart(const sensortypes::FirmwareHeader &header)
+{
+	uint8_t image_header[image_header_length] = {'F', 'L', 'X', 'I', 'M', 'G', ':', 0, 0, ':'};
+	image_header[7] = header.image_size >> 8;
+	image_header[8] = header.image_size & 0xFF;
+	SpiFlash::getInstance()->write(0, image_header, image_header_length);
+
+	RadioManager::getInstance()->stopReceiving();
+	wdt_enable(WDTO_15MS);
+	while (1)
+	{
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+Receives a firmware image streamed by the hub over the radio and stages it in
+the external flash. Chunks are acknowledged in windows, so the hub only resends
+what was lost. A verified image is handed to the DualOptiboot bootloader, which
+copies it to the program memory on the next reset.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "common/sensortypes.h"
+
+namespace sensor
+{
+	// The bootloader looks for "FLXIMG:", the image size (msb first) and ":"
+	// at the start of the flash, the image follows right after.
+	const uint8_t image_header_length = 10;
+	// Program memory minus the 2K of the bootloader
+	const uint16_t max_image_size = 30720;
+	// Seconds without a frame before the update is abandoned
+	const uint16_t firmware_idle_timeout = 10;
+	// Milliseconds without a chunk before an incomplete window is acked
+	const uint8_t firmware_window_timeout = 50;
+
+	class FirmwareUpdater
+	{
+	public:
+		FirmwareUpdater(FirmwareUpdater const &) = delete;
+		void operator=(FirmwareUpdater const &) = delete;
+		// Methods
+		static FirmwareUpdater *getInstance();
+		void init(uint8_t flash_cs_pin);
+		bool update();
+
+	private:
+		// Methods
+		FirmwareUpdater();
+		bool verify(const sensortypes::FirmwareHeader &header);
+		void sendWindowAck(uint16_t base, uint8_t received, sensortypes::firmware_status_t status);
+		void restart(const sensortypes::FirmwareHeader &header);
+		// Variables
+		static FirmwareUpdater *m_instance;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "InputManager.h"
+#include "common/PinChange.h"
+
+// Variables
+sensor::InputManager *sensor::InputManager::m_instance = nullptr;
+sensor::SensorInput sensor::InputManager::m_inputs[max_inputs];
+uint8_t sensor::InputManager::m_count = 0;
+volatile uint8_t sensor::InputManager::m_armed = 0;
+volatile uint8_t sensor::InputManager::m_levels = 0;
+volatile uint8_t sensor::InputManager::m_triggered = 0;
+
+// Methods
+sensor::InputManager *sensor::InputManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new InputManager();
+	}
+	return m_instance;
+}
+
+sensor::InputManager::InputManager()
+{
+	PinChange::attach(onPinChange);
+}
+
+// Registers a detector and sets its pin as an input. Returns the index
+// of its bit in the masks.
+uint8_t sensor::InputManager::addInput(uint8_t pin, sensortypes::sensor_type_t type)
+{
+	pinMode(pin, INPUT);
+	m_inputs[m_count].pin = pin;
+	m_inputs[m_count].type = type;
+	return m_count++;
+}
+
+// Returns the mask of the inputs with a type that the arm type of the hub covers.
+// Tamper inputs are not part of the type ordering and are always covered.
+uint8_t sensor::InputManager::getTypeMask(sensortypes::sensor_type_t sensors_to_arm)
+{
+	uint8_t mask = 0;
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		if (m_inputs[i].type == sensortypes::type_tamper || sensors_to_arm >= m_inputs[i].type)
+		{
+			mask |= (1 << i);
+		}
+	}
+	return mask;
+}
+
+// Enables the pin change interrupt of the inputs in the mask and disables the rest.
+void sensor::InputManager::arm(uint8_t mask)
+{
+	// The interrupt also disarms inputs, keep it out until the mask is stored
+	noInterrupts();
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		uint8_t pin = m_inputs[i].pin;
+		uint8_t input_bit = (1 << i);
+		if ((mask & input_bit) && !(m_armed & input_bit))
+		{
+			// Start from the current level, so only a new rising edge triggers
+			if (digitalRead(pin) == HIGH)
+			{
+				m_levels |= input_bit;
+			}
+			else
+			{
+				m_levels &= ~input_bit;
+			}
+			PinChange::enable(pin);
+		}
+		else if (!(mask & input_bit))
+		{
+			PinChange::disable(pin);
+		}
+	}
+	m_armed = mask;
+	interrupts();
+}
+
+// Returns the mask of the armed inputs.
+uint8_t sensor::InputManager::getArmedMask()
+{
+	return m_armed;
+}
+
+// Returns the mask of the inputs that triggered since they were last cleared.
+uint8_t sensor::InputManager::getTriggeredMask()
+{
+	return m_triggered;
+}
+
+// Clears the given triggered inputs, once their event is reported.
+void sensor::InputManager::clearTriggered(uint8_t mask)
+{
+	noInterrupts();
+	m_triggered &= ~mask;
+	interrupts();
+}
+
+// Marks the given inputs as triggered again, for an event still pending before a reset.
+void sensor::InputManager::restoreTriggered(uint8_t mask)
+{
+	noInterrupts();
+	m_triggered |= mask;
+	interrupts();
+}
+
+// Is called only by the interrupts, marks the armed inputs that went high as triggered
+// and disarms them to prevent the firing of multiple interupts disrupting the program flow.
+void sensor::InputManager::onPinChange()
+{
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		uint8_t input_bit = (1 << i);
+		if (!(m_armed & input_bit))
+		{
+			continue;
+		}
+
+		uint8_t pin = m_inputs[i].pin;
+		bool is_high = digitalRead(pin) == HIGH;
+		if (is_high && !(m_levels & input_bit))
+		{
+			m_triggered |= input_bit;
+			m_armed &= ~input_bit;
+			PinChange::disable(pin);
+		}
+
+		if (is_high)
+		{
+			m_levels |= input_bit;
+		}
+		else
+		{
+			m_levels &= ~input_bit;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+Manages the detector inputs of the sensor. Every input is watched through a
+pin change interrupt (see common/PinChange.h) while armed and reports its
+rising edge as a bit in the triggered mask, so a single board can serve
+several detectors.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "common/sensortypes.h"
+
+namespace sensor
+{
+	// One bit per input in the masks of the message and the ack
+	const uint8_t max_inputs = 8;
+
+	// A detector wired to an input pin
+	typedef struct SensorInput
+	{
+		uint8_t pin = 0;
+		sensortypes::sensor_type_t type = sensortypes::type_none;
+	} SensorInput;
+
+	class InputManager
+	{
+	public:
+		InputManager(InputManager const &) = delete;
+		void operator=(InputManager const &) = delete;
+		// Methods
+		static InputManager *getInstance();
+		uint8_t addInput(uint8_t pin, sensortypes::sensor_type_t type);
+		uint8_t getTypeMask(sensortypes::sensor_type_t sensors_to_arm);
+		void arm(uint8_t mask);
+		uint8_t getArmedMask();
+		uint8_t getTriggeredMask();
+		void clearTriggered(uint8_t mask);
+		void restoreTriggered(uint8_t mask);
+		static void onPinChange();
+
+	private:
+		// Methods
+		InputManager();
+		// Variables
+		static InputManager *m_instance;
+		static SensorInput m_inputs[max_inputs];
+		static uint8_t m_count;
+		static volatile uint8_t m_armed;
+		static volatile uint8_t m_levels;
+		static volatile uint8_t m_triggered;
+	};
+} // namespace sensor
\ No newline at end of file
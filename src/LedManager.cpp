@@ -0,0 +1,88 @@
+#include "LedManager.h"
+#include "ConfigManager.h"
+#include "PowerManager.h"
+
+sensor::LedManager *sensor::LedManager::m_instance = nullptr;
+
+sensor::LedManager *sensor::LedManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new LedManager();
+	}
+	return m_instance;
+}
+
+sensor::LedManager::LedManager()
+{
+	m_edges_left = 0;
+	m_is_lit = false;
+}
+
+// Sets the led pin as an output, turned off.
+void sensor::LedManager::init(uint8_t led_pin)
+{
+	m_led_pin = led_pin;
+	pinMode(m_led_pin, OUTPUT);
+	setLit(false);
+}
+
+// Turns the led on or off, stopping any pattern.
+void sensor::LedManager::setLit(bool is_lit)
+{
+	m_edges_left = 0;
+	m_is_lit = is_lit;
+	digitalWrite(m_led_pin, is_lit ? HIGH : LOW);
+}
+
+// Starts a pattern, it is played by the following sleepUntilNextEdge calls.
+void sensor::LedManager::play(const LedPattern &pattern)
+{
+	setLit(false);
+	m_pattern = pattern;
+	m_edges_left = pattern.blinks * 2;
+}
+
+// Returns true while the pattern has edges left.
+bool sensor::LedManager::isPlaying()
+{
+	return m_edges_left > 0;
+}
+
+// Powers the mcu down for the current on or off time of the pattern and then
+// toggles the led. The pin keeps driving the led while the mcu sleeps.
+void sensor::LedManager::sleepUntilNextEdge()
+{
+	if (m_edges_left == 0)
+	{
+		return;
+	}
+
+	period_t period = getIntervalPeriod();
+	uint8_t intervals = m_is_lit ? m_pattern.on_intervals : m_pattern.off_intervals;
+	for (uint8_t i = 0; i < intervals; i++)
+	{
+		PowerManager::getInstance()->powerDown(period);
+	}
+
+	m_is_lit = !m_is_lit;
+	digitalWrite(m_led_pin, m_is_lit ? HIGH : LOW);
+	m_edges_left--;
+}
+
+// Returns the watchdog period closest to the configured led interval.
+period_t sensor::LedManager::getIntervalPeriod()
+{
+	uint16_t interval = ConfigManager::getInstance()->get().led_interval;
+	uint8_t closest = SLEEP_15MS;
+	for (uint8_t i = SLEEP_30MS; i <= SLEEP_8S; i++)
+	{
+		int32_t distance = (int32_t)PowerManager::getPeriodMillis((period_t)i) - interval;
+		int32_t closest_distance = (int32_t)PowerManager::getPeriodMillis((period_t)closest) - interval;
+		if (abs(distance) < abs(closest_distance))
+		{
+			closest = i;
+		}
+	}
+	return (period_t)closest;
+}
\ No newline at end of file
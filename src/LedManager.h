@@ -0,0 +1,56 @@
+/*
+Plays blink patterns on the status led without keeping the mcu awake. The
+pattern advances one edge at a time from the sleep loop, with the mcu powered
+down between the edges and woken by the watchdog.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <LowPower.h>
+
+namespace sensor
+{
+	// A blink code, the on and off times are counted in led intervals
+	typedef struct LedPattern
+	{
+		uint8_t blinks;
+		uint8_t on_intervals;
+		uint8_t off_intervals;
+	} LedPattern;
+
+	// Blink codes
+	const LedPattern pattern_setup_success = {3, 1, 1};
+	const LedPattern pattern_setup_failed = {1, 1, 1};
+	const LedPattern pattern_signal_lost = {5, 1, 1};
+
+	class LedManager
+	{
+	public:
+		LedManager(LedManager const &) = delete;
+		void operator=(LedManager const &) = delete;
+		// Methods
+		static LedManager *getInstance();
+		void init(uint8_t led_pin);
+		void setLit(bool is_lit);
+		void play(const LedPattern &pattern);
+		bool isPlaying();
+		void sleepUntilNextEdge();
+
+	private:
+		// Methods
+		LedManager();
+		period_t getIntervalPeriod();
+		// Variables
+		static LedManager *m_instance;
+		uint8_t m_led_pin;
+		LedPattern m_pattern;
+		uint8_t m_edges_left;
+		bool m_is_lit;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "MemoryMonitor.h"
+
+// Symbols of the avr-libc linker script and malloc
+extern uint8_t _end;	 // End of the static data, where the heap starts
+extern uint8_t __stack;	 // Top of the RAM, where the stack starts
+extern char *__brkval;	 // End of the heap, null until the first allocation
+
+// Paints the RAM between the static data and the stack. Runs from the .init3 section,
+// after the stack pointer is set and before the constructors allocate the singletons.
+void paintStack() __attribute__((naked, used, section(".init3")));
+void paintStack()
+{
+	uint8_t *p = &_end;
+	while (p <= &__stack)
+	{
+		*p = sensor::stack_paint;
+		p++;
+	}
+}
+
+sensor::MemoryMonitor *sensor::MemoryMonitor::m_instance = nullptr;
+
+sensor::MemoryMonitor *sensor::MemoryMonitor::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new MemoryMonitor();
+	}
+	return m_instance;
+}
+
+sensor::MemoryMonitor::MemoryMonitor()
+{
+	m_wakes = 0;
+	m_stack_headroom = 0;
+}
+
+// Counts a wake and scans the painted RAM every few of them.
+void sensor::MemoryMonitor::update()
+{
+	if (m_wakes == 0)
+	{
+		scan();
+	}
+	m_wakes = (m_wakes + 1) % memory_scan_interval;
+}
+
+// Counts the painted bytes above the heap, the stack reached as low as the first
+// byte that is not painted. A stack byte that happens to hold the paint value makes
+// the count a little high, which is why the margin left should not be cut to zero.
+void sensor::MemoryMonitor::scan()
+{
+	uint8_t *p = __brkval != nullptr ? (uint8_t *)__brkval : &_end;
+	uint8_t *stack = (uint8_t *)SP;
+	uint16_t headroom = 0;
+	while (p < stack && *p == stack_paint)
+	{
+		p++;
+		headroom++;
+	}
+	m_stack_headroom = headroom;
+}
+
+// Returns the bytes between the heap and the stack right now.
+uint16_t sensor::MemoryMonitor::getFreeRam()
+{
+	uint8_t *heap = __brkval != nullptr ? (uint8_t *)__brkval : &_end;
+	return (uint8_t *)SP - heap;
+}
+
+// Returns the bytes the heap and the stack never used, as of the last scan.
+uint16_t sensor::MemoryMonitor::getStackHeadroom()
+{
+	return m_stack_headroom;
+}
+
+diagnostics::MemoryReport sensor::MemoryMonitor::getReport()
+{
+	diagnostics::MemoryReport report;
+	report.free_ram = getFreeRam();
+	report.stack_headroom = m_stack_headroom;
+	return report;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+/*
+Measures how close the heap and the stack come to each other. The free RAM is
+painted with a pattern before the constructors run, the painted bytes left
+between the heap and the stack were never used since boot. The scan of those
+bytes runs every few wakes, so it costs little awake time.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "common/diagnostics.h"
+
+namespace sensor
+{
+	// Value painted over the free RAM at boot
+	const uint8_t stack_paint = 0xC5;
+	// Wakes between scans of the painted RAM
+	const uint8_t memory_scan_interval = 16;
+
+	class MemoryMonitor
+	{
+	public:
+		MemoryMonitor(MemoryMonitor const &) = delete;
+		void operator=(MemoryMonitor const &) = delete;
+		// Methods
+		static MemoryMonitor *getInstance();
+		void update();
+		void scan();
+		uint16_t getFreeRam();
+		uint16_t getStackHeadroom();
+		diagnostics::MemoryReport getReport();
+
+	private:
+		// Methods
+		MemoryMonitor();
+		// Variables
+		static MemoryMonitor *m_instance;
+		uint8_t m_wakes;
+		uint16_t m_stack_headroom;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "Nrf24.h"
+
+// Commands
+const uint8_t nrf_read_register = 0x00;
+const uint8_t nrf_write_register = 0x20;
+const uint8_t nrf_read_payload = 0x61;
+const uint8_t nrf_write_payload = 0xA0;
+const uint8_t nrf_write_ack_payload = 0xA8;
+const uint8_t nrf_read_payload_width = 0x60;
+const uint8_t nrf_flush_tx = 0xE1;
+const uint8_t nrf_flush_rx = 0xE2;
+const uint8_t nrf_activate = 0x50;
+const uint8_t nrf_nop = 0xFF;
+
+// Registers
+const uint8_t nrf_config = 0x00;
+const uint8_t nrf_enable_auto_ack = 0x01;
+const uint8_t nrf_enabled_pipes = 0x02;
+const uint8_t nrf_setup_retransmit = 0x04;
+const uint8_t nrf_channel = 0x05;
+const uint8_t nrf_rf_setup = 0x06;
+const uint8_t nrf_status = 0x07;
+const uint8_t nrf_observe_tx = 0x08;
+const uint8_t nrf_rx_address_p0 = 0x0A;
+const uint8_t nrf_rx_address_p1 = 0x0B;
+const uint8_t nrf_tx_address = 0x10;
+const uint8_t nrf_dynamic_payloads = 0x1C;
+const uint8_t nrf_feature = 0x1D;
+
+// Register bits
+const uint8_t nrf_prim_rx = 0x01;
+const uint8_t nrf_power_up = 0x02;
+const uint8_t nrf_crc_16 = 0x0C;
+const uint8_t nrf_status_tx_full = 0x01;
+const uint8_t nrf_status_rx_pipe = 0x0E;
+const uint8_t nrf_status_max_rt = 0x10;
+const uint8_t nrf_status_tx_ds = 0x20;
+const uint8_t nrf_status_rx_dr = 0x40;
+const uint8_t nrf_status_irq = nrf_status_rx_dr | nrf_status_tx_ds | nrf_status_max_rt;
+const uint8_t nrf_feature_ack_payloads = 0x06; // Dynamic payloads and ack payloads
+const uint8_t nrf_pipe_0 = 0x01;
+const uint8_t nrf_pipe_1 = 0x02;
+
+sensor::Nrf24::Nrf24(uint8_t ce_pin, uint8_t csn_pin)
+{
+	m_ce_pin = ce_pin;
+	m_csn_pin = csn_pin;
+	m_status = 0;
+	m_config = 0;
+	m_enabled_pipes = 0;
+	m_channel = 0;
+	m_pa_level = nrf24_pa_max;
+	m_tx_address = 0;
+	m_rx_address = 0;
+}
+
+// Sets the radio up for auto acked writes with ack payloads and leaves it powered down.
+// Returns false if the radio does not answer.
+bool sensor::Nrf24::begin(uint8_t channel, uint8_t pa_level)
+{
+	pinMode(m_ce_pin, OUTPUT);
+	pinMode(m_csn_pin, OUTPUT);
+	digitalWrite(m_ce_pin, LOW);
+	digitalWrite(m_csn_pin, HIGH);
+	SPI.begin();
+	// The power on reset of the radio is over long before setup runs, give it a few ms after the pins settle
+	delay(5);
+
+	writeRegister(nrf_setup_retransmit, (nrf24_retransmit_delay << 4) | nrf24_retransmit_count);
+	m_pa_level = pa_level;
+	// 1Mbps, the lowest bit is the LNA gain of the nRF24L01
+	writeRegister(nrf_rf_setup, (m_pa_level << 1) | 1);
+	writeRegister(nrf_enable_auto_ack, 0x3F);
+
+	// The nRF24L01 needs the features activated first, the nRF24L01+ has them on
+	writeRegister(nrf_feature, nrf_feature_ack_payloads);
+	if (readRegister(nrf_feature) != nrf_feature_ack_payloads)
+	{
+		select();
+		SPI.transfer(nrf_activate);
+		SPI.transfer(0x73);
+		unselect();
+		writeRegister(nrf_feature, nrf_feature_ack_payloads);
+	}
+	writeRegister(nrf_dynamic_payloads, nrf_pipe_0 | nrf_pipe_1);
+
+	m_channel = channel;
+	writeRegister(nrf_channel, m_channel);
+	m_enabled_pipes = nrf_pipe_0 | nrf_pipe_1;
+	writeRegister(nrf_enabled_pipes, m_enabled_pipes);
+	writeRegister(nrf_status, nrf_status_irq);
+	flush_rx();
+	flush_tx();
+	m_config = nrf_crc_16;
+	writeRegister(nrf_config, m_config);
+	return readRegister(nrf_setup_retransmit) == ((nrf24_retransmit_delay << 4) | nrf24_retransmit_count);
+}
+
+// Leaves power down, the oscillator needs 1.5ms before the radio can transmit.
+void sensor::Nrf24::powerUp()
+{
+	if (!(m_config & nrf_power_up))
+	{
+		writeConfig(m_config | nrf_power_up);
+		delayMicroseconds(1500);
+	}
+}
+
+void sensor::Nrf24::powerDown()
+{
+	digitalWrite(m_ce_pin, LOW);
+	writeConfig(m_config & ~nrf_power_up);
+}
+
+// Listens on pipe 1 only, pipe 0 takes the acks of writes and would pick up
+// the frames other sensors send to the same address.
+void sensor::Nrf24::startListening()
+{
+	writeEnabledPipes(nrf_pipe_1);
+	writeConfig(m_config | nrf_power_up | nrf_prim_rx);
+	writeRegister(nrf_status, nrf_status_irq);
+	digitalWrite(m_ce_pin, HIGH);
+}
+
+// Leaves listening. Ack payloads still queued are dropped, the next write would send them.
+void sensor::Nrf24::stopListening()
+{
+	digitalWrite(m_ce_pin, LOW);
+	if (m_config & nrf_prim_rx)
+	{
+		writeConfig(m_config & ~nrf_prim_rx);
+		flush_tx();
+	}
+	writeEnabledPipes(nrf_pipe_0 | nrf_pipe_1);
+}
+
+// Sets the address of the writes, pipe 0 takes their acks so it gets the same one.
+void sensor::Nrf24::openWritingPipe(uint64_t address)
+{
+	if (address != m_tx_address)
+	{
+		writeAddress(nrf_rx_address_p0, address);
+		writeAddress(nrf_tx_address, address);
+		m_tx_address = address;
+	}
+}
+
+// Sets the address pipe 1 listens on.
+void sensor::Nrf24::openReadingPipe(uint64_t address)
+{
+	if (address != m_rx_address)
+	{
+		writeAddress(nrf_rx_address_p1, address);
+		m_rx_address = address;
+	}
+}
+
+void sensor::Nrf24::setChannel(uint8_t channel)
+{
+	if (channel != m_channel)
+	{
+		writeRegister(nrf_channel, channel);
+		m_channel = channel;
+	}
+}
+
+// Writes the payload and waits until it is acked or the retransmits run out.
+// The status read while clearing the interrupt flags tells if an ack payload came with the ack.
+bool sensor::Nrf24::write(const void *buffer, uint8_t length)
+{
+	const uint8_t *bytes = (const uint8_t *)buffer;
+	select();
+	SPI.transfer(nrf_write_payload);
+	for (uint8_t i = 0; i < length; i++)
+	{
+		SPI.transfer(bytes[i]);
+	}
+	unselect();
+
+	// CE stays high until the write ends, a pulse of 10us would be enough otherwise
+	digitalWrite(m_ce_pin, HIGH);
+	uint32_t start = millis();
+	while (!(command(nrf_nop) & (nrf_status_tx_ds | nrf_status_max_rt)) && millis() - start < nrf24_write_timeout)
+	{
+	}
+	digitalWrite(m_ce_pin, LOW);
+
+	writeRegister(nrf_status, nrf_status_irq);
+	if (!(m_status & nrf_status_tx_ds))
+	{
+		// The payload stays in the fifo after a failed write
+		flush_tx();
+		return false;
+	}
+	return true;
+}
+
+// Returns true if the last write was acked with a payload. Acks arrive on pipe 0,
+// a frame received on pipe 1 while listening is not taken for one.
+bool sensor::Nrf24::isAckPayloadAvailable()
+{
+	return (m_status & nrf_status_rx_pipe) == 0;
+}
+
+// Returns true if a payload was received while listening.
+bool sensor::Nrf24::available()
+{
+	return (command(nrf_nop) & nrf_status_rx_pipe) != nrf_status_rx_pipe;
+}
+
+// Returns the size of the received payload, or 0 if it is corrupt, which is then flushed.
+uint8_t sensor::Nrf24::getDynamicPayloadSize()
+{
+	select();
+	SPI.transfer(nrf_read_payload_width);
+	uint8_t size = SPI.transfer(nrf_nop);
+	unselect();
+	if (size > 32)
+	{
+		flush_rx();
+		return 0;
+	}
+	return size;
+}
+
+// Reads the received payload in one burst and clears the received flag.
+void sensor::Nrf24::read(void *buffer, uint8_t length)
+{
+	uint8_t *bytes = (uint8_t *)buffer;
+	select();
+	SPI.transfer(nrf_read_payload);
+	for (uint8_t i = 0; i < length; i++)
+	{
+		bytes[i] = SPI.transfer(nrf_nop);
+	}
+	unselect();
+	writeRegister(nrf_status, nrf_status_rx_dr);
+}
+
+// Queues an ack payload for the next frame received on pipe 1.
+// Returns false if the fifo was full and the payload was not queued.
+bool sensor::Nrf24::writeAckPayload(const void *buffer, uint8_t length)
+{
+	const uint8_t *bytes = (const uint8_t *)buffer;
+	select();
+	uint8_t status = SPI.transfer(nrf_write_ack_payload | 1);
+	for (uint8_t i = 0; i < length; i++)
+	{
+		SPI.transfer(bytes[i]);
+	}
+	unselect();
+	m_status = status;
+	return !(status & nrf_status_tx_full);
+}
+
+void sensor::Nrf24::flush_rx()
+{
+	command(nrf_flush_rx);
+}
+
+void sensor::Nrf24::flush_tx()
+{
+	command(nrf_flush_tx);
+}
+
+// Returns the auto retransmits of the last write.
+uint8_t sensor::Nrf24::getARC()
+{
+	return readRegister(nrf_observe_tx) & 0x0F;
+}
+
+uint8_t sensor::Nrf24::getChannel()
+{
+	return m_channel;
+}
+
+uint8_t sensor::Nrf24::getPALevel()
+{
+	return m_pa_level;
+}
+
+uint8_t sensor::Nrf24::getDataRate()
+{
+	return nrf24_1mbps;
+}
+
+void sensor::Nrf24::select()
+{
+	SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+	digitalWrite(m_csn_pin, LOW);
+}
+
+void sensor::Nrf24::unselect()
+{
+	digitalWrite(m_csn_pin, HIGH);
+	SPI.endTransaction();
+}
+
+// Sends a single byte command, returns the status.
+uint8_t sensor::Nrf24::command(uint8_t command)
+{
+	select();
+	m_status = SPI.transfer(command);
+	unselect();
+	return m_status;
+}
+
+uint8_t sensor::Nrf24::readRegister(uint8_t reg)
+{
+	select();
+	m_status = SPI.transfer(nrf_read_register | reg);
+	uint8_t value = SPI.transfer(nrf_nop);
+	unselect();
+	return value;
+}
+
+void sensor::Nrf24::writeRegister(uint8_t reg, uint8_t value)
+{
+	select();
+	m_status = SPI.transfer(nrf_write_register | reg);
+	SPI.transfer(value);
+	unselect();
+}
+
+// Writes a 5 byte address in one burst, the least significant byte first.
+void sensor::Nrf24::writeAddress(uint8_t reg, uint64_t address)
+{
+	select();
+	m_status = SPI.transfer(nrf_write_register | reg);
+	for (uint8_t i = 0; i < 5; i++)
+	{
+		SPI.transfer(address >> (8 * i));
+	}
+	unselect();
+}
+
+void sensor::Nrf24::writeConfig(uint8_t config)
+{
+	if (config != m_config)
+	{
+		writeRegister(nrf_config, config);
+		m_config = config;
+	}
+}
+
+void sensor::Nrf24::writeEnabledPipes(uint8_t pipes)
+{
+	if (pipes != m_enabled_pipes)
+	{
+		writeRegister(nrf_enabled_pipes, pipes);
+		m_enabled_pipes = pipes;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+A minimal driver for the nRF24L01(+) radio, covering only what the sensor
+uses: writes with auto ack and ack payloads, listening on one pipe and
+queueing ack payloads for relaying. The registers the sensor changes are
+cached, so repeated settings and mode changes cost no SPI transactions, and
+the status byte every command returns is kept to answer ack payload checks.
+The caller claims the SPI bus, as the RadioManager does around each use.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <SPI.h>
+
+namespace sensor
+{
+	// Power amplifier levels, as reported in the radio traces
+	const uint8_t nrf24_pa_max = 3;
+	// Data rates, as reported in the radio traces
+	const uint8_t nrf24_1mbps = 0;
+	// Auto retransmit delay in steps of 250us and count, the delay fits a full ack payload
+	const uint8_t nrf24_retransmit_delay = 5;
+	const uint8_t nrf24_retransmit_count = 15;
+	// Milliseconds a write may take, above the longest auto retransmit sequence
+	const uint8_t nrf24_write_timeout = 60;
+
+	class Nrf24
+	{
+	public:
+		Nrf24(uint8_t ce_pin, uint8_t csn_pin);
+		Nrf24(Nrf24 const &) = delete;
+		void operator=(Nrf24 const &) = delete;
+		// Methods
+		bool begin(uint8_t channel, uint8_t pa_level);
+		void powerUp();
+		void powerDown();
+		void startListening();
+		void stopListening();
+		void openWritingPipe(uint64_t address);
+		void openReadingPipe(uint64_t address);
+		void setChannel(uint8_t channel);
+		bool write(const void *buffer, uint8_t length);
+		bool isAckPayloadAvailable();
+		bool available();
+		uint8_t getDynamicPayloadSize();
+		void read(void *buffer, uint8_t length);
+		bool writeAckPayload(const void *buffer, uint8_t length);
+		void flush_rx();
+		void flush_tx();
+		uint8_t getARC();
+		uint8_t getChannel();
+		uint8_t getPALevel();
+		uint8_t getDataRate();
+
+	private:
+		// Methods
+		void select();
+		void unselect();
+		uint8_t command(uint8_t command);
+		uint8_t readRegister(uint8_t reg);
+		void writeRegister(uint8_t reg, uint8_t value);
+		void writeAddress(uint8_t reg, uint64_t address);
+		void writeConfig(uint8_t config);
+		void writeEnabledPipes(uint8_t pipes);
+		// Variables
+		uint8_t m_ce_pin;
+		uint8_t m_csn_pin;
+		uint8_t m_status;		 // Status returned by the last command
+		uint8_t m_config;		 // Cached CONFIG register
+		uint8_t m_enabled_pipes; // Cached EN_RXADDR register
+		uint8_t m_channel;
+		uint8_t m_pa_level;
+		uint64_t m_tx_address;
+		uint64_t m_rx_address;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "PowerManager.h"
+#include "ClockManager.h"
+#include "EventLog.h"
+
+sensor::PowerManager *sensor::PowerManager::m_instance = nullptr;
+
+sensor::PowerManager *sensor::PowerManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new PowerManager();
+	}
+	return m_instance;
+}
+
+sensor::PowerManager::PowerManager()
+{
+	memset(m_claims, 0, sizeof(m_claims));
+}
+
+// Switches off every peripheral that is not claimed yet.
+void sensor::PowerManager::init()
+{
+	apply();
+}
+
+// Switches the peripheral on, it stays on until every claim is released.
+void sensor::PowerManager::claim(power_domain_t domain)
+{
+	m_claims[getIndex(domain)]++;
+	apply();
+}
+
+// Releases a claim, the peripheral is switched off with the last one.
+void sensor::PowerManager::release(power_domain_t domain)
+{
+	uint8_t index = getIndex(domain);
+	if (m_claims[index] > 0)
+	{
+		m_claims[index]--;
+	}
+	apply();
+}
+
+// Powers the mcu down for a watchdog period. Every sleep goes through here, so
+// the event log keeps the time slept while millis() stops.
+void sensor::PowerManager::powerDown(period_t period)
+{
+	LowPower.powerDown(period, ADC_OFF, BOD_OFF);
+	EventLog::getInstance()->addSleep(getPeriodMillis(period));
+}
+
+// Returns the nominal milliseconds of a watchdog period.
+uint16_t sensor::PowerManager::getPeriodMillis(period_t period)
+{
+	switch (period)
+	{
+	case SLEEP_15MS:
+		return 15;
+	case SLEEP_30MS:
+		return 30;
+	case SLEEP_60MS:
+		return 60;
+	case SLEEP_120MS:
+		return 120;
+	case SLEEP_250MS:
+		return 250;
+	case SLEEP_500MS:
+		return 500;
+	case SLEEP_1S:
+		return 1000;
+	case SLEEP_2S:
+		return 2000;
+	case SLEEP_4S:
+		return 4000;
+	case SLEEP_8S:
+		return 8000;
+	default:
+		return 0;
+	}
+}
+
+// Writes the power reduction register from the claims. The ADC has to be
+// disabled before its clock is stopped and enabled again after it restarts.
+// The full clock is restored before a peripheral that depends on it starts.
+void sensor::PowerManager::apply()
+{
+	uint8_t gated = 0;
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		if ((all_domains & _BV(i)) && m_claims[i] == 0)
+		{
+			gated |= _BV(i);
+		}
+	}
+
+	bool needs_full_speed = (full_speed_domains & ~gated) != 0;
+	if (needs_full_speed)
+	{
+		ClockManager::getInstance()->setFullSpeed(true);
+	}
+
+	if (gated & domain_adc)
+	{
+		ADCSRA &= ~_BV(ADEN);
+	}
+	PRR = (PRR & ~all_domains) | gated;
+	if (!(gated & domain_adc))
+	{
+		ADCSRA |= _BV(ADEN);
+	}
+
+	if (!needs_full_speed)
+	{
+		ClockManager::getInstance()->setFullSpeed(false);
+	}
+}
+
+// Returns the PRR bit number of the domain.
+uint8_t sensor::PowerManager::getIndex(power_domain_t domain)
+{
+	uint8_t index = 0;
+	while (!(domain & _BV(index)))
+	{
+		index++;
+	}
+	return index;
+}
\ No newline at end of file
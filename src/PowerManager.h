@@ -0,0 +1,58 @@
+/*
+Gates the clock of the on chip peripherals through the power reduction register.
+Every subsystem claims the peripherals it uses for as long as it uses them and
+everything that is not claimed stays switched off. Timer 0 is never gated, as
+it keeps the time for millis and delay. The system clock is lowered while none
+of the peripherals that depend on it is claimed.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <LowPower.h>
+
+namespace sensor
+{
+	// Peripherals that can be switched off, the values are their PRR bits
+	typedef enum power_domain_t
+	{
+		domain_adc = _BV(PRADC),
+		domain_usart = _BV(PRUSART0),
+		domain_spi = _BV(PRSPI),
+		domain_timer1 = _BV(PRTIM1),
+		domain_timer2 = _BV(PRTIM2),
+		domain_twi = _BV(PRTWI)
+	} power_domain_t;
+
+	const uint8_t all_domains = domain_adc | domain_usart | domain_spi | domain_timer1 | domain_timer2 | domain_twi;
+	// Peripherals that need the full clock, for their bit rates and the ADC clock
+	const uint8_t full_speed_domains = domain_adc | domain_usart | domain_spi | domain_twi;
+
+	class PowerManager
+	{
+	public:
+		PowerManager(PowerManager const &) = delete;
+		void operator=(PowerManager const &) = delete;
+		// Methods
+		static PowerManager *getInstance();
+		void init();
+		void claim(power_domain_t domain);
+		void release(power_domain_t domain);
+		void powerDown(period_t period);
+		static uint16_t getPeriodMillis(period_t period);
+
+	private:
+		// Methods
+		PowerManager();
+		void apply();
+		uint8_t getIndex(power_domain_t domain);
+		// Variables
+		static PowerManager *m_instance;
+		uint8_t m_claims[8]; // Claim count per PRR bit, so claims can nest
+	};
+} // namespace sensor
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "RadioManager.h"
+#include "ConfigManager.h"
+#include "PowerManager.h"
 
 //#define DEBUG
+// Writes every frame as a binary trace record to the serial port, see common/radiotrace.h
+//#define RADIO_TRACE
 
 sensor::RadioManager *sensor::RadioManager::m_instance = nullptr;
 
@@ -16,60 +20,83 @@ sensor::RadioManager *sensor::RadioManager::getInstance()
 sensor::RadioManager::RadioManager()
 {
 	m_sent = false;
+	m_writes = 0;
+	m_via_relay = false;
+	m_relaying = false;
 }
 
 // Initialize radio communications.
 void sensor::RadioManager::init(uint8_t ce_pin, uint8_t csn_pin)
 {
 	// Create the radio object and set some settings.
-	m_radio = new RF24(ce_pin, csn_pin);
-	m_radio->begin();
-	m_radio->setPALevel(RF24_PA_MAX);							 // High power consumption and more dbs.
-	m_radio->setChannel(channel);								 // See comments on channel constant.
-	m_radio->setAutoAck(true);									 // Ensure autoACK is enabled.
-	m_radio->enableAckPayload();								 // Allow optional ack payloads.
-	m_radio->setPayloadSize(sizeof(sensortypes::SensorMessage)); // Payload is equal to the message size
-
-	// Open the pipes for reading and writing.
+	PowerManager::getInstance()->claim(domain_spi);
+	m_radio = new Nrf24(ce_pin, csn_pin);
+	m_radio->begin(ConfigManager::getInstance()->get().channel, nrf24_pa_max); // See comments on channel constant.
+
+#ifdef RADIO_TRACE
+	PowerManager::getInstance()->claim(domain_usart);
+	Serial.begin(115200);
+#endif
+
+	// Open the pipes for reading and writing, the radio stays off until it is used.
 	m_radio->openWritingPipe(addresses[0]);
-	m_radio->openReadingPipe(1, addresses[1]);
-	m_radio->startListening();
+	m_radio->openReadingPipe(addresses[1]);
+	m_radio->powerDown();
+	PowerManager::getInstance()->release(domain_spi);
+}
+
+// Moves the radio to another channel.
+void sensor::RadioManager::setChannel(uint8_t channel)
+{
+	PowerManager::getInstance()->claim(domain_spi);
+	m_radio->setChannel(channel);
+	PowerManager::getInstance()->release(domain_spi);
 }
 
 // Sends the message passed on the arguements and returns the response. If not sent, the message
 // is resent on random intervals between limits, for up to the set number of retries.
-// If the no timeouts arguement is true, the message will be resent until received.
-sensortypes::SensorAck sensor::RadioManager::send(const sensortypes::SensorMessage &message, bool hasNoTimeout)
+// Messages that must get through are retried later by the DeliveryPolicy, never in here.
+// When a relay is configured, the route that worked last is tried first and the other one
+// gets a few writes after it fails. The relay route is only preferred once a relay returned
+// the hub's ack, without a relay every write goes to the hub.
+sensortypes::SensorAck sensor::RadioManager::send(const sensortypes::SensorMessage &message)
 {
+	PowerManager::getInstance()->claim(domain_spi);
 	m_radio->powerUp();
 	m_radio->stopListening();
 
-	// Delay a random ammount of seconds, that way is improbable that the
-	// message with colide again with another sensor, as that sensor will
-	// delay random microseconds too.
-	bool sent = false;
+	const sensortypes::SensorConfig &config = ConfigManager::getInstance()->get();
 	uint8_t retries = 0;
-	do
+	// A relay sends its own messages straight to the hub
+	bool has_relay = config.relay && !m_relaying;
+	bool via_relay = m_via_relay && has_relay;
+	m_radio->openWritingPipe(via_relay ? relay_address : addresses[0]);
+	bool sent = write(message, config.max_retries, retries);
+	m_writes = retries;
+	if (!sent && has_relay)
 	{
-		sent = m_radio->write(&message, sizeof(message));
-		if (!sent)
-		{
-			delayMicroseconds(random(min_delay, max_delay));
-			retries++;
-		}
-	} while (!sent && (retries < max_retries || hasNoTimeout));
+		via_relay = !via_relay;
+		m_radio->openWritingPipe(via_relay ? relay_address : addresses[0]);
+		sent = write(message, fallback_retries, retries);
+		m_writes += retries;
+	}
 
 	// If the message was successfully sent, get the ack payload.
 	sensortypes::SensorAck response;
+	bool has_ack = false;
 	if (sent)
 	{
-		// m_radio->startListening();
-
-		// If a payload is received.
-		if (m_radio->isAckPayloadAvailable())
+		m_writes++;
+		if (via_relay)
+		{
+			sent = pollRelay(message, response);
+			has_ack = sent;
+		}
+		else if (m_radio->isAckPayloadAvailable())
 		{
 			// Read the response and flush the rx if it is an error.
 			m_radio->read(&response, sizeof(response));
+			has_ack = true;
 
 			// Without flushing the rx register, in case of a failed ack
 			// it will fail clearing it and fail all the next attempts to send anything.
@@ -78,7 +105,13 @@ sensortypes::SensorAck sensor::RadioManager::send(const sensortypes::SensorMessa
 		}
 	}
 
-#ifdef DEBUG
+#ifdef RADIO_TRACE
+	trace(radiotrace::direction_tx, sent ? radiotrace::flag_delivered : 0, retries, &message, sizeof(message));
+	if (has_ack)
+	{
+		trace(radiotrace::direction_ack, radiotrace::flag_delivered, 0, &response, sizeof(response));
+	}
+#elif defined(DEBUG)
 	Serial.print("Sent: ");
 	Serial.print(sent ? "True" : "False");
 	Serial.print(", Message: [");
@@ -86,23 +119,253 @@ sensortypes::SensorAck sensor::RadioManager::send(const sensortypes::SensorMessa
 	Serial.print(String(message.session_id) + ", ");
 	Serial.print(String(message.sensor_id) + ", ");
 	Serial.print(String(message.type) + ", ");
-	Serial.print(String(message.state));
+	Serial.print(String(message.state) + ", ");
+	Serial.print(String(message.config_version) + ", ");
+	Serial.print(String(message.inputs_triggered));
 	Serial.print("], Ack: [");
 	Serial.print(String(response.parent_device_id) + ", ");
 	Serial.print(String(response.session_id) + ", ");
-	Serial.print(String(response.sensors_to_arm));
+	Serial.print(String(response.sensors_to_arm) + ", ");
+	Serial.print(String(response.heartbeat_wakes) + ", ");
+	Serial.print(String(response.config_version) + ", ");
+	Serial.print(String(response.inputs_to_arm) + ", ");
+	Serial.print(String(response.command));
 	Serial.print("], Retries: ");
 	Serial.println(retries);
 	Serial.flush();
 #endif
 
+	m_radio->openWritingPipe(addresses[0]);
 	m_radio->powerDown();
+	PowerManager::getInstance()->release(domain_spi);
 	m_sent = sent;
+	m_via_relay = via_relay && sent;
 	return response;
 }
 
+// The ack of a relay only tells the relay got the message, the relay then forwards it and
+// queues the hub's ack. Writes the message again, which the relay does not forward twice,
+// until the ack echoes this message. Returns true only then, the response is the hub's ack.
+bool sensor::RadioManager::pollRelay(const sensortypes::SensorMessage &message, sensortypes::SensorAck &response)
+{
+	for (uint8_t i = 0; i < relay_ack_polls; i++)
+	{
+		m_radio->flush_rx();
+		delay(relay_ack_delay);
+		m_writes++;
+		if (m_radio->write(&message, sizeof(message)) && m_radio->isAckPayloadAvailable())
+		{
+			sensortypes::SensorAck ack;
+			m_radio->read(&ack, sizeof(ack));
+			if (ack.sensor_id == message.sensor_id && ack.sequence == message.sequence)
+			{
+				m_radio->flush_rx();
+				response = ack;
+				return true;
+			}
+		}
+	}
+	m_radio->flush_rx();
+	return false;
+}
+
+// Writes the message until it is acked, for up to the given retries. Returns true if
+// it was acked, the retries are set to the number of writes that were not.
+bool sensor::RadioManager::write(const sensortypes::SensorMessage &message, uint8_t max_retries, uint8_t &retries)
+{
+	// Delay a random ammount of seconds, that way is improbable that the
+	// message with colide again with another sensor, as that sensor will
+	// delay random microseconds too.
+	const sensortypes::SensorConfig &config = ConfigManager::getInstance()->get();
+	bool sent = false;
+	retries = 0;
+	do
+	{
+		sent = m_radio->write(&message, sizeof(message));
+		if (!sent)
+		{
+			delayMicroseconds(random(config.min_delay, config.max_delay));
+			retries++;
+		}
+	} while (!sent && retries < max_retries);
+	return sent;
+}
+
 // Returns the sent flag for the last message attempt.
 bool sensor::RadioManager::wasSent()
 {
 	return m_sent;
+}
+
+// Returns the number of writes the last message attempt took.
+uint8_t sensor::RadioManager::getWrites()
+{
+	return m_writes;
+}
+
+// Returns true if the last message went through a relay.
+bool sensor::RadioManager::wasRelayed()
+{
+	return m_via_relay;
+}
+
+// Powers up the radio and listens on the reading pipe, used by the modes
+// where the hub streams data to the sensor. The SPI stays on until stopReceiving.
+void sensor::RadioManager::startReceiving()
+{
+	PowerManager::getInstance()->claim(domain_spi);
+	m_radio->powerUp();
+	m_radio->startListening();
+}
+
+// Reads a pending payload into the buffer. Returns the payload size, or 0 if
+// nothing was received. Payloads larger than the buffer are dropped.
+uint8_t sensor::RadioManager::receive(void *buffer, uint8_t length)
+{
+	if (!m_radio->available())
+	{
+		return 0;
+	}
+
+	uint8_t size = m_radio->getDynamicPayloadSize();
+	if (size == 0 || size > length)
+	{
+		m_radio->flush_rx();
+		return 0;
+	}
+	m_radio->read(buffer, size);
+#ifdef RADIO_TRACE
+	trace(radiotrace::direction_rx, radiotrace::flag_delivered, 0, buffer, size);
+#endif
+	return size;
+}
+
+// Sends a payload to the hub while in receiving mode and returns to listening.
+bool sensor::RadioManager::transmit(const void *buffer, uint8_t length)
+{
+	m_radio->stopListening();
+	bool sent = m_radio->write(buffer, length);
+#ifdef RADIO_TRACE
+	trace(radiotrace::direction_tx, sent ? radiotrace::flag_delivered : 0, 0, buffer, length);
+#endif
+	m_radio->startListening();
+	return sent;
+}
+
+// Stops listening and powers the radio down.
+void sensor::RadioManager::stopReceiving()
+{
+	m_radio->stopListening();
+	m_radio->powerDown();
+	PowerManager::getInstance()->release(domain_spi);
+}
+
+// Sends a join request to the provisioning address. Returns true if the ack payload
+// carried a join response, which is copied to the response. The response may be
+// meant for another sensor, the caller checks the nonce.
+bool sensor::RadioManager::join(const sensortypes::JoinRequest &request, sensortypes::JoinResponse &response)
+{
+	PowerManager::getInstance()->claim(domain_spi);
+	m_radio->powerUp();
+	m_radio->stopListening();
+	m_radio->openWritingPipe(provisioning_address);
+
+	bool has_response = false;
+	bool sent = m_radio->write(&request, sizeof(request));
+	if (sent && m_radio->isAckPayloadAvailable())
+	{
+		m_radio->read(&response, sizeof(response));
+		m_radio->flush_rx();
+		has_response = true;
+	}
+
+#ifdef RADIO_TRACE
+	trace(radiotrace::direction_tx, sent ? radiotrace::flag_delivered : 0, 0, &request, sizeof(request));
+#endif
+
+	m_radio->openWritingPipe(addresses[0]);
+	m_radio->powerDown();
+	PowerManager::getInstance()->release(domain_spi);
+	return has_response;
+}
+
+// Listens for sensor messages on the relay address, the radio stays powered up
+// as relays are mains powered. Called again after a join, which powers the radio down.
+void sensor::RadioManager::startRelaying()
+{
+	if (!m_relaying)
+	{
+		PowerManager::getInstance()->claim(domain_spi);
+		m_relaying = true;
+	}
+	m_radio->powerUp();
+	m_radio->openReadingPipe(relay_address);
+	m_radio->startListening();
+}
+
+// Forwards a message to the hub while relaying and returns to listening.
+// Returns true if the hub acked it with a payload, which is copied to the response.
+// The received frames must be read first, the ack is taken from the head of the fifo.
+// Leaving listening drops the queued ack payloads, the caller queues them again.
+bool sensor::RadioManager::forward(const sensortypes::SensorMessage &message, sensortypes::SensorAck &response)
+{
+	m_radio->stopListening();
+	uint8_t retries = 0;
+	bool sent = write(message, ConfigManager::getInstance()->get().max_retries, retries);
+	bool has_ack = sent && m_radio->isAckPayloadAvailable();
+	if (has_ack)
+	{
+		m_radio->read(&response, sizeof(response));
+	}
+
+#ifdef RADIO_TRACE
+	trace(radiotrace::direction_tx, sent ? radiotrace::flag_delivered : 0, retries, &message, sizeof(message));
+	if (has_ack)
+	{
+		trace(radiotrace::direction_ack, radiotrace::flag_delivered, 0, &response, sizeof(response));
+	}
+#endif
+
+	m_radio->startListening();
+	return has_ack;
+}
+
+// Queues an ack payload for the next message received on the relay address.
+// Returns false if the queue of the radio is full.
+bool sensor::RadioManager::queueAck(const sensortypes::SensorAck &ack)
+{
+	return m_radio->writeAckPayload(&ack, sizeof(ack));
+}
+
+// Writes a binary trace record of a frame, see common/radiotrace.h for the format.
+void sensor::RadioManager::trace(radiotrace::trace_direction_t direction, uint8_t flags, uint8_t retries, const void *frame, uint8_t length)
+{
+	radiotrace::TraceRecord record;
+	record.timestamp = millis();
+	record.direction = direction;
+	record.flags = flags;
+	record.retries = retries;
+	record.arc = m_radio->getARC();
+	record.pa_level = m_radio->getPALevel();
+	record.data_rate = m_radio->getDataRate();
+	record.channel = m_radio->getChannel();
+	record.length = length;
+
+	// The avr is little endian and packs the struct, so both can be written as they are
+	uint8_t checksum = 0;
+	const uint8_t *bytes = (const uint8_t *)&record;
+	for (uint8_t i = 0; i < radiotrace::trace_record_size; i++)
+	{
+		checksum ^= bytes[i];
+	}
+	bytes = (const uint8_t *)frame;
+	for (uint8_t i = 0; i < length; i++)
+	{
+		checksum ^= bytes[i];
+	}
+
+	Serial.write(radiotrace::trace_sync);
+	Serial.write((const uint8_t *)&record, radiotrace::trace_record_size);
+	Serial.write((const uint8_t *)frame, length);
+	Serial.write(checksum);
 }
\ No newline at end of file
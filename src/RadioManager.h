@@ -1,5 +1,5 @@
 /*
-Manages the radio communications using the rf24 library.
+Manages the radio communications through the nRF24 driver.
 */
 
 #pragma once
@@ -11,20 +11,28 @@ Manages the radio communications using the rf24 library.
 #endif
 
 #include "common/sensortypes.h"
-// Radio libraries
-#include <SPI.h>
-#include <nRF24L01.h>
-#include <RF24.h>
+#include "common/radiotrace.h"
+#include "Nrf24.h"
 
 namespace sensor
 {
-	// Radio constants
+	// Radio constants, the channel and retry values are the defaults
+	// of the remote configuration
 	const uint64_t addresses[2] = {0xABCDABCD71LL, 0x544d52687CLL};
+	// Address the hub listens on for join requests of sensors in install mode
+	const uint64_t provisioning_address = 0x50524F5631LL;
+	// Address relays listen on, sensors with a relay configured fall back to it when the hub is out of reach
+	const uint64_t relay_address = 0x52454C4159LL;
+	// Writes tried through the route that is not the preferred one
+	const uint8_t fallback_retries = 3;
+	// Polls of a relay for the hub's ack of a relayed message and milliseconds between them
+	const uint8_t relay_ack_polls = 8;
+	const uint8_t relay_ack_delay = 25;
 	const uint8_t channel = 125; // Sets the frequency to 2525Mhz, above the Wifi range
-	// Max used from the rf24 library from the setRetries function
+	// Same as the auto retransmit count of the radio, see Nrf24.h
 	const uint8_t max_retries = 15;
 	// The min and max delay microseconds, the range is the same with the one
-	// used from the rf24 library for the setRetries function.
+	// of the auto retransmit delay of the radio.
 	const uint16_t min_delay = 250;
 	const uint16_t max_delay = 4000;
 
@@ -36,15 +44,32 @@ namespace sensor
 		// Methods
 		static RadioManager *getInstance();
 		void init(uint8_t ce_pin, uint8_t csn_pin);
-		sensortypes::SensorAck send(const sensortypes::SensorMessage &message, bool hasNoTimeout);
+		void setChannel(uint8_t channel);
+		sensortypes::SensorAck send(const sensortypes::SensorMessage &message);
 		bool wasSent();
+		uint8_t getWrites();
+		bool wasRelayed();
+		void startReceiving();
+		uint8_t receive(void *buffer, uint8_t length);
+		bool transmit(const void *buffer, uint8_t length);
+		void stopReceiving();
+		bool join(const sensortypes::JoinRequest &request, sensortypes::JoinResponse &response);
+		void startRelaying();
+		bool forward(const sensortypes::SensorMessage &message, sensortypes::SensorAck &response);
+		bool queueAck(const sensortypes::SensorAck &ack);
 
 	private:
 		// Methods
 		RadioManager();
+		bool write(const sensortypes::SensorMessage &message, uint8_t max_retries, uint8_t &retries);
+		bool pollRelay(const sensortypes::SensorMessage &message, sensortypes::SensorAck &response);
+		void trace(radiotrace::trace_direction_t direction, uint8_t flags, uint8_t retries, const void *frame, uint8_t length);
 		// Variables
 		static RadioManager *m_instance;
-		RF24 *m_radio;
-		bool m_sent; // True if the last message was sent
+		Nrf24 *m_radio;
+		bool m_sent;	  // True if the last message was sent
+		uint8_t m_writes; // Writes spent on the last message
+		bool m_via_relay; // True if the hub acked the last message through a relay
+		bool m_relaying;  // True once the radio listens for sensors to relay
 	};
 } // namespace sensor
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "RelayManager.h"
+#include "RadioManager.h"
+
+sensor::RelayManager *sensor::RelayManager::m_instance = nullptr;
+
+sensor::RelayManager *sensor::RelayManager::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new RelayManager();
+	}
+	return m_instance;
+}
+
+sensor::RelayManager::RelayManager()
+{
+	m_parent_device_id = 0;
+	m_session_id = 0;
+	m_count = 0;
+	m_next = 0;
+	m_ack_count = 0;
+}
+
+// Starts relaying the messages of the given network, the table of known
+// sensors is cleared as their ids may belong to another network. A join
+// in between drops the acks queued in the radio.
+void sensor::RelayManager::init(uint32_t parent_device_id, uint16_t session_id)
+{
+	m_parent_device_id = parent_device_id;
+	m_session_id = session_id;
+	m_count = 0;
+	m_next = 0;
+	m_ack_count = 0;
+	RadioManager::getInstance()->startRelaying();
+}
+
+// Forwards the received messages to the hub, if any. All of them are read from the
+// radio first, so the ack of a forward is the only payload left in it.
+void sensor::RelayManager::poll()
+{
+	RadioManager *radio = RadioManager::getInstance();
+	sensortypes::SensorMessage messages[relay_fifo_depth];
+	uint8_t count = 0;
+	while (count < relay_fifo_depth && radio->receive(&messages[count], sizeof(sensortypes::SensorMessage)) == sizeof(sensortypes::SensorMessage))
+	{
+		// The radio acked the frame with the oldest queued ack
+		popAck();
+		count++;
+	}
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		relay(messages[i]);
+	}
+}
+
+// Listens on the relay address again after the relay sent its own message,
+// which powers the radio down and drops the queued acks.
+void sensor::RelayManager::resume()
+{
+	RadioManager::getInstance()->startRelaying();
+	requeueAcks();
+}
+
+// Forwards a message to the hub and queues the hub's ack. Messages of other networks,
+// already relayed ones and the polls of a sensor for its ack are dropped.
+void sensor::RelayManager::relay(sensortypes::SensorMessage &message)
+{
+	if (message.parent_device_id != m_parent_device_id || message.session_id != m_session_id || message.hops != 0)
+	{
+		return;
+	}
+
+	// The sensor writes again to collect the ack, the repeat is not forwarded
+	if (isRepeat(message))
+	{
+		return;
+	}
+
+	uint8_t sequence = message.sequence;
+	message.hops++;
+	sensortypes::SensorAck response;
+	if (RadioManager::getInstance()->forward(message, response))
+	{
+		// The sensor takes the ack as delivery only if it echoes its message
+		response.sensor_id = message.sensor_id;
+		response.sequence = sequence;
+		pushAck(response);
+	}
+	requeueAcks();
+}
+
+// Returns true if the message repeats the last one forwarded for its sensor within the
+// repeat window, otherwise stores it as the last one forwarded.
+bool sensor::RelayManager::isRepeat(const sensortypes::SensorMessage &message)
+{
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		if (m_sensors[i].sensor_id == message.sensor_id)
+		{
+			if (m_sensors[i].sequence == message.sequence && millis() - m_sensors[i].forwarded_at < relay_repeat_window)
+			{
+				return true;
+			}
+			m_sensors[i].sequence = message.sequence;
+			m_sensors[i].forwarded_at = millis();
+			return false;
+		}
+	}
+
+	m_sensors[m_next].sensor_id = message.sensor_id;
+	m_sensors[m_next].sequence = message.sequence;
+	m_sensors[m_next].forwarded_at = millis();
+	m_next = (m_next + 1) % max_relayed_sensors;
+	if (m_count < max_relayed_sensors)
+	{
+		m_count++;
+	}
+	return false;
+}
+
+// Adds an ack to the mirror, dropping the oldest one when the radio holds no more.
+void sensor::RelayManager::pushAck(const sensortypes::SensorAck &ack)
+{
+	if (m_ack_count == relay_fifo_depth)
+	{
+		popAck();
+	}
+	m_acks[m_ack_count] = ack;
+	m_ack_count++;
+}
+
+// Removes the oldest ack from the mirror, once the radio sent it.
+void sensor::RelayManager::popAck()
+{
+	if (m_ack_count == 0)
+	{
+		return;
+	}
+	for (uint8_t i = 1; i < m_ack_count; i++)
+	{
+		m_acks[i - 1] = m_acks[i];
+	}
+	m_ack_count--;
+}
+
+// Queues the mirrored acks in the radio again, after a forward dropped them.
+void sensor::RelayManager::requeueAcks()
+{
+	for (uint8_t i = 0; i < m_ack_count; i++)
+	{
+		RadioManager::getInstance()->queueAck(m_acks[i]);
+	}
+}
\ No newline at end of file
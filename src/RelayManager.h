@@ -0,0 +1,68 @@
+/*
+Turns a mains powered sensor into a relay for sensors out of reach of the hub.
+The relay listens on the relay address, forwards the messages of its own
+network once and queues the ack of the hub for the sensor to collect with its
+next write. The queued acks are mirrored in RAM, as forwarding drops them
+from the radio. Forwarded messages are never relayed again, so a route has at
+most one hop and cannot loop. The relay still reports its own inputs, its
+messages go straight to the hub between the polls.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "common/sensortypes.h"
+
+namespace sensor
+{
+	// Sensors a relay keeps the last sequence of, the oldest entry is replaced when full
+	const uint8_t max_relayed_sensors = 16;
+	// Milliseconds a repeated message counts as a poll for the hub's ack, later
+	// it is the next retry round of the sensor and is forwarded again
+	const uint16_t relay_repeat_window = 500;
+	// Frames and ack payloads the radio holds
+	const uint8_t relay_fifo_depth = 3;
+
+	// Last message forwarded for a sensor
+	typedef struct RelayedSensor
+	{
+		uint8_t sensor_id = 0;
+		uint8_t sequence = 0;
+		uint32_t forwarded_at = 0;
+	} RelayedSensor;
+
+	class RelayManager
+	{
+	public:
+		RelayManager(RelayManager const &) = delete;
+		void operator=(RelayManager const &) = delete;
+		// Methods
+		static RelayManager *getInstance();
+		void init(uint32_t parent_device_id, uint16_t session_id);
+		void poll();
+		void resume();
+
+	private:
+		// Methods
+		RelayManager();
+		bool isRepeat(const sensortypes::SensorMessage &message);
+		void relay(sensortypes::SensorMessage &message);
+		void pushAck(const sensortypes::SensorAck &ack);
+		void popAck();
+		void requeueAcks();
+		// Variables
+		static RelayManager *m_instance;
+		uint32_t m_parent_device_id;
+		uint16_t m_session_id;
+		RelayedSensor m_sensors[max_relayed_sensors];
+		uint8_t m_count;
+		uint8_t m_next;
+		sensortypes::SensorAck m_acks[relay_fifo_depth]; // Acks queued in the radio, the oldest first
+		uint8_t m_ack_count;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "RetainedState.h"
+#include <util/crc16.h>
+
+// Reset flags passed by the bootloader
+uint8_t boot_reset_flags __attribute__((section(".noinit")));
+
+// Optiboot, DualOptiboot included, clears MCUSR before starting the sketch and passes
+// its value in r2. Runs from .init0, before the startup code uses r2.
+void captureResetFlags() __attribute__((naked, used, section(".init0")));
+void captureResetFlags()
+{
+	__asm__ __volatile__("sts %0, r2\n"
+						 : "=m"(boot_reset_flags)
+						 :);
+}
+
+sensor::RetainedState *sensor::RetainedState::m_instance = nullptr;
+sensor::RetainedData sensor::RetainedState::m_data __attribute__((section(".noinit")));
+
+sensor::RetainedState *sensor::RetainedState::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new RetainedState();
+	}
+	return m_instance;
+}
+
+sensor::RetainedState::RetainedState() {}
+
+// Returns the cause of the last reset as MCUSR flags, from the bootloader or from MCUSR
+// itself when the sketch runs without one. Read once in setup, before MCUSR is cleared.
+// Needs a bootloader that passes the flags in r2, older ones leave r2 undefined.
+uint8_t sensor::RetainedState::getResetFlags()
+{
+	return boot_reset_flags | MCUSR;
+}
+
+// Returns true if the retained state survived the reset and can be used.
+// The state is invalidated right away, a reset during boot then starts cold.
+bool sensor::RetainedState::restore(uint8_t reset_flags)
+{
+	bool is_valid = !(reset_flags & _BV(PORF)) && m_data.magic == retained_magic && m_data.crc == checksum(m_data);
+	m_data.magic = 0;
+	return is_valid;
+}
+
+// Returns the retained state, only valid after restore returned true.
+const sensor::RetainedData &sensor::RetainedState::get()
+{
+	return m_data;
+}
+
+// Stores the state, called before every sleep so a reset finds the latest one.
+void sensor::RetainedState::save(const RetainedData &data)
+{
+	m_data = data;
+	m_data.magic = retained_magic;
+	m_data.crc = checksum(m_data);
+}
+
+// Crc of every field before the crc itself.
+uint16_t sensor::RetainedState::checksum(const RetainedData &data)
+{
+	const uint8_t *bytes = (const uint8_t *)&data;
+	uint16_t crc = 0;
+	for (uint8_t i = 0; i < sizeof(RetainedData) - sizeof(data.crc); i++)
+	{
+		crc = _crc_xmodem_update(crc, bytes[i]);
+	}
+	return crc;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/*
+Keeps the state a sensor needs to resume after a reset in RAM that the startup
+code leaves untouched. After a watchdog, brownout or external reset the state is
+restored if its magic and crc match, so an armed sensor stays armed and a pending
+event is still delivered. After a power on reset the RAM holds noise and the
+sensor starts from the EEPROM as before.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+namespace sensor
+{
+	// Marks retained state, change it whenever RetainedData changes
+	const uint16_t retained_magic = 0x5202;
+
+	// State kept across resets. It has no default values, a constructor
+	// would clear it at startup.
+	typedef struct RetainedData
+	{
+		uint16_t magic;
+		uint32_t parent_device_id;
+		uint16_t session_id;
+		uint8_t sensor_id;
+		uint8_t sequence;		 // Sequence of the last message
+		uint8_t armed_mask;		 // Inputs armed by the hub
+		uint8_t triggered_mask;	 // Inputs of the event not yet delivered
+		bool delivery_pending;	 // Delivery state of the event, see DeliveryPolicy
+		uint8_t delivery_round;
+		uint16_t delivery_elapsed;
+		uint16_t delivery_writes;
+		uint8_t heartbeat_wakes; // Heartbeat interval set by the hub
+		uint8_t channel;		 // Channel the sensor hopped to
+		uint16_t crc;
+	} RetainedData;
+
+	class RetainedState
+	{
+	public:
+		RetainedState(RetainedState const &) = delete;
+		void operator=(RetainedState const &) = delete;
+		// Methods
+		static RetainedState *getInstance();
+		static uint8_t getResetFlags();
+		bool restore(uint8_t reset_flags);
+		const RetainedData &get();
+		void save(const RetainedData &data);
+
+	private:
+		// Methods
+		RetainedState();
+		static uint16_t checksum(const RetainedData &data);
+		// Variables
+		static RetainedState *m_instance;
+		static RetainedData m_data;
+	};
+} // namespace sensor
\ No newline at end of file
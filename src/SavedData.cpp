@@ -1,5 +1,7 @@
 #include "SavedData.h"
 
+//#define DEBUG
+
 sensor::SavedData *sensor::SavedData::m_instance = nullptr;
 
 sensor::SavedData *sensor::SavedData::getInstance()
@@ -34,17 +36,23 @@ void sensor::SavedData::saveDeviceId(uint32_t device_id)
 	char buffer[device_id_length + 1];
 	memset(buffer, 0, device_id_length + 1);
 	sprintf(buffer, "%lu", device_id);
+#ifdef DEBUG
 	Serial.print(buffer);
 	Serial.print(" ");
+#endif
 	for (int i = 0; i < device_id_length; i++)
 	{
+#ifdef DEBUG
 		Serial.print(device_id_address + i);
 		Serial.print("(" + String(buffer[i]) + ")");
 
 		Serial.print(", ");
+#endif
 		EEPROM.write(device_id_address + i, buffer[i]);
 	}
+#ifdef DEBUG
 	Serial.println();
+#endif
 }
 
 // Reads the device id from the specified address.
@@ -70,18 +78,24 @@ void sensor::SavedData::saveSessionId(uint16_t session_id)
 	char buffer[session_id_length + 1];
 	memset(buffer, 0, session_id_length + 1);
 	sprintf(buffer, "%u", session_id);
+#ifdef DEBUG
 	Serial.print(buffer);
 	Serial.print(" ");
+#endif
 
 	for (int i = 0; i < session_id_length; i++)
 	{
+#ifdef DEBUG
 		Serial.print(session_id_address + i);
 		Serial.print("(" + String(buffer[i]) + ")");
 
 		Serial.print(", ");
+#endif
 		EEPROM.write(session_id_address + i, buffer[i]);
 	}
+#ifdef DEBUG
 	Serial.println();
+#endif
 }
 
 // Reads the session id from the specified address.
@@ -107,17 +121,23 @@ void sensor::SavedData::saveSensorId(uint8_t sensor_id)
 	char buffer[sensor_id_length + 1];
 	memset(buffer, 0, sensor_id_length + 1);
 	sprintf(buffer, "%hu", sensor_id);
+#ifdef DEBUG
 	Serial.print(buffer);
 	Serial.print(" ");
+#endif
 	for (int i = 0; i < sensor_id_length; i++)
 	{
+#ifdef DEBUG
 		Serial.print(sensor_id_address + i);
 		Serial.print("(" + String(buffer[i]) + ")");
 
 		Serial.print(", ");
+#endif
 		EEPROM.write(sensor_id_address + i, buffer[i]);
 	}
+#ifdef DEBUG
 	Serial.println();
+#endif
 }
 
 // Reads the sensor id from the specified address.
@@ -135,4 +155,23 @@ uint8_t sensor::SavedData::readSensorId()
 		buffer[i] = c;
 	}
 	return strtoul(buffer, NULL, 0);
+}
+
+// Saves the configuration struct, only the changed bytes are written.
+void sensor::SavedData::saveConfig(const sensortypes::SensorConfig &config)
+{
+	EEPROM.put(config_address, config);
+	EEPROM.update(config_cookie_address, config_cookie_value);
+}
+
+// Reads the configuration struct. Returns false if no configuration
+// has been saved yet, leaving the passed struct untouched.
+bool sensor::SavedData::readConfig(sensortypes::SensorConfig &config)
+{
+	if (EEPROM.read(config_cookie_address) != config_cookie_value)
+	{
+		return false;
+	}
+	EEPROM.get(config_address, config);
+	return true;
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ the information is stored.
 #endif
 
 #include <EEPROM.h>
+#include "common/sensortypes.h"
 
 namespace sensor
 {
@@ -25,6 +26,11 @@ namespace sensor
 	const uint8_t session_id_length = 5;
 	const uint8_t sensor_id_address = session_id_address + session_id_length;
 	const uint8_t sensor_id_length = 3;
+	// The remote configuration is stored after the ids, behind its own cookie
+	// since sensors in the field already carry the memory init cookie.
+	const uint8_t config_cookie_address = sensor_id_address + sensor_id_length;
+	const uint8_t config_cookie_value = 0xC7;
+	const uint8_t config_address = config_cookie_address + 1;
 
 	class SavedData
 	{
@@ -40,6 +46,8 @@ namespace sensor
 		uint16_t readSessionId();
 		void saveSensorId(uint8_t device_id);
 		uint8_t readSensorId();
+		void saveConfig(const sensortypes::SensorConfig &config);
+		bool readConfig(sensortypes::SensorConfig &config);
 
 	private:
 		// Methods
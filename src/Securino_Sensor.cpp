@@ -1,8 +1,19 @@
 #include <LowPower.h>
 #include "RadioManager.h"
 #include "BatteryMonitor.h"
+#include "ChannelManager.h"
 #include "SetupManager.h"
 #include "SavedData.h"
+#include "ConfigManager.h"
+#include "InputManager.h"
+#include "FirmwareUpdater.h"
+#include "LedManager.h"
+#include "MemoryMonitor.h"
+#include "DeliveryPolicy.h"
+#include "EventLog.h"
+#include "PowerManager.h"
+#include "RetainedState.h"
+#include "RelayManager.h"
 #include "common/Timer.h"
 #include "common/sensortypes.h"
 
@@ -12,23 +23,24 @@
 // Pin constants
 const uint8_t voltage_pin = A1;
 const uint8_t sensor_pin = 2;
+const uint8_t window_pin = 6;
+const uint8_t tamper_pin = 7;
+const uint8_t flash_cs_pin = 8;
 const uint8_t led_pin = 3;
 const uint8_t button_pin = 4;
 const uint8_t sensor_type_pin = 5;
 const uint8_t ce_pin = 9;
 const uint8_t csn_pin = 10;
+const uint8_t relay_pin = A2; // Jumpered to ground on mains powered sensors that relay
+const uint8_t entropy_pin = A0; // Left unconnected, its noise seeds the join nonce
 
-// Sleep cycles
-const uint8_t sleep_cycles_armed = 24;
+// Sleep cycles, the armed cycle count is part of the remote configuration
 const period_t sleep_cycle_armed = SLEEP_1S;
 const uint8_t sleep_cycles_disarmed = 3;
 const period_t sleep_cycle_disarmed = SLEEP_8S;
 
-// Time between led blinks and blink codes
-const uint16_t led_interval = 200;
-const uint8_t setup_success_blinks = 3;
-const uint8_t setup_failed_blinks = 1;
-const uint8_t signal_lost_blinks = 5;
+// Wakes between heartbeat pings, until the hub sets another interval
+const uint8_t default_heartbeat_wakes = 1;
 #pragma endregion
 
 #pragma region Global
@@ -37,101 +49,228 @@ sensor::BatteryMonitor *g_battery = sensor::BatteryMonitor::getInstance();
 sensor::RadioManager *g_radio = sensor::RadioManager::getInstance();
 sensor::SetupManager *g_setup = sensor::SetupManager::getInstance();
 sensor::SavedData *g_data = sensor::SavedData::getInstance();
+sensor::ConfigManager *g_config = sensor::ConfigManager::getInstance();
+sensor::InputManager *g_inputs = sensor::InputManager::getInstance();
+sensor::FirmwareUpdater *g_updater = sensor::FirmwareUpdater::getInstance();
+sensor::LedManager *g_led = sensor::LedManager::getInstance();
+sensor::DeliveryPolicy *g_delivery = sensor::DeliveryPolicy::getInstance();
+sensor::PowerManager *g_power = sensor::PowerManager::getInstance();
+sensor::RelayManager *g_relay = sensor::RelayManager::getInstance();
+sensor::EventLog *g_log = sensor::EventLog::getInstance();
+sensor::ChannelManager *g_channels = sensor::ChannelManager::getInstance();
+sensor::MemoryMonitor *g_memory = sensor::MemoryMonitor::getInstance();
+sensor::RetainedState *g_retained = sensor::RetainedState::getInstance();
 
 // Variables
-volatile uint8_t g_state;
-bool g_is_armed;
+uint8_t g_state;
 sensortypes::SensorMessage g_message;
+uint8_t g_heartbeat_wakes = default_heartbeat_wakes;
+uint8_t g_wakes_since_send = default_heartbeat_wakes;
+uint8_t g_reported_state = sensortypes::state_ping;
+uint8_t g_masked_inputs = 0; // Inputs reported in an event, kept disarmed until the next heartbeat ack
+bool g_relaying = false;
+uint32_t g_relay_wake_at = 0; // Millis of the last wake of a relay, which never sleeps
+bool g_battery_low = false;
 #pragma endregion
 
 #pragma region Forward Declarations
 void updateSensorState();
-void changeArmStatus(bool);
+void changeArmStatus(uint8_t);
 void mcuSleep();
 void bindSensor();
-void sensorTriggerEvent();
-void sendData(bool);
+void sendData();
+void sendEvent();
+bool hasNewEvent();
+void updateFirmware();
+bool isRelayWakeDue();
+void saveRetainedState();
 #pragma endregion
 
 void setup()
 {
+	// Switch off the peripherals and lower the clock, each subsystem claims the
+	// peripherals it uses and the full clock comes back with them
+	g_power->init();
+
 #ifdef DEBUG
 	// Initialzie serial
+	g_power->claim(sensor::domain_usart);
 	Serial.begin(115200);
 #endif
 
 	// Set the pinmodes
-	pinMode(sensor_pin, INPUT);
 	pinMode(sensor_type_pin, INPUT);
-	pinMode(led_pin, OUTPUT);
+	pinMode(relay_pin, INPUT_PULLUP);
 
 	// Initialize the device EEPROM memory
 	g_data->initializeMemory();
 
+	// Log the cause of the reset, the flags are cleared for the next one.
+	// After a warm reset the state before it is still in RAM.
+	uint8_t reset_flags = sensor::RetainedState::getResetFlags();
+	MCUSR = 0;
+	g_log->init();
+	g_log->log(eventlog::event_reset, reset_flags);
+	bool is_warm = g_retained->restore(reset_flags);
+	const sensor::RetainedData &retained = g_retained->get();
+
+	// Load the configuration pushed by the hub, if any
+	g_config->init();
+
+	// The led plays its patterns while the mcu sleeps
+	g_led->init(led_pin);
+
 	// Initialize battery manager and get the sensor state
 	g_battery->init(voltage_pin);
 	updateSensorState();
 
-	// Collect data from EEPROM for the message
-	g_message.parent_device_id = g_data->readDeviceId();
-	g_message.session_id = g_data->readSessionId();
-	g_message.sensor_id = g_data->readSensorId();
+	// Collect data for the message, from EEPROM unless it was retained
+	if (is_warm)
+	{
+		g_message.parent_device_id = retained.parent_device_id;
+		g_message.session_id = retained.session_id;
+		g_message.sensor_id = retained.sensor_id;
+		g_message.sequence = retained.sequence;
+		g_heartbeat_wakes = retained.heartbeat_wakes;
+	}
+	else
+	{
+		g_message.parent_device_id = g_data->readDeviceId();
+		g_message.session_id = g_data->readSessionId();
+		g_message.sensor_id = g_data->readSensorId();
+	}
 	g_message.type = digitalRead(sensor_type_pin) == HIGH ? sensortypes::type_pir : sensortypes::type_magnet;
+
+	// Register the detectors, the main one has the type selected by the type pin.
+	// The hub arms only the inputs that are wired, through the input mask.
+	g_inputs->addInput(sensor_pin, g_message.type);
+	g_inputs->addInput(window_pin, sensortypes::type_magnet);
+	g_inputs->addInput(tamper_pin, sensortypes::type_tamper);
 	g_message.state = (sensortypes::sensor_state_t)g_state;
+	g_message.config_version = g_config->get().version;
 
 	// Random seed is unique for each sensor in the network, based on the unique sensor id.
 	randomSeed(g_message.sensor_id);
 
-	// Default arm status is disarmed
-	changeArmStatus(false);
+	// Default arm status is disarmed, a warm reset resumes the arm status and the pending event.
+	// The reset likely cut a round of the event short, a brownout while sending for one, so that
+	// round is charged to the budget and the next one waits for its delay like any other retry.
+	bool is_resumed = false;
+	if (is_warm)
+	{
+		changeArmStatus(retained.armed_mask);
+		if (retained.delivery_pending)
+		{
+			g_delivery->resume(retained.delivery_round, retained.delivery_elapsed, retained.delivery_writes);
+			g_delivery->onAttempt(false, g_config->get().max_retries);
+			is_resumed = g_delivery->isPending();
+			if (g_delivery->wasDropped())
+			{
+				g_log->log(eventlog::event_dropped, retained.triggered_mask);
+			}
+		}
+		if (is_resumed || !retained.delivery_pending)
+		{
+			g_inputs->restoreTriggered(retained.triggered_mask);
+		}
+	}
+	else
+	{
+		changeArmStatus(0);
+	}
 
-	// Intialize Radio
+	// Intialize Radio and the flash that stages firmware updates, they share the SPI bus
 	g_radio->init(ce_pin, csn_pin);
+	g_channels->init();
+	if (is_warm)
+	{
+		g_channels->follow(retained.channel);
+	}
+	g_updater->init(flash_cs_pin);
 
-	// Initialize the class that handles cable setup with main device
-	g_setup->init(button_pin, sensortypes::type_pir);
+	// Initialize the class that handles cable and radio setup with main device
+	g_setup->init(button_pin, sensortypes::type_pir, g_message.type, entropy_pin);
+
+	// Relays keep the radio listening and never sleep
+	g_relaying = digitalRead(relay_pin) == LOW;
+	if (g_relaying)
+	{
+		g_relay->init(g_message.parent_device_id, g_message.session_id);
+	}
 
 #ifdef DEBUG
 	Serial.println("Sensor type: " + String(g_message.type));
 	Serial.println("Loaded Ids: " + String(g_message.parent_device_id) + ", " + String(g_message.session_id) + ", " + String(g_message.sensor_id));
 #endif
+
+	// Back off before the next round of a resumed event
+	if (is_resumed && !g_relaying)
+	{
+		mcuSleep();
+	}
 }
 
 void loop()
 {
-	// If the button is pressed, intialize sensor setup
+	// If the button was pressed, intialize sensor setup
 	if (g_setup->isSetup())
 	{
 		bindSensor();
+		if (g_relaying)
+		{
+			g_relay->init(g_message.parent_device_id, g_message.session_id);
+		}
 	}
 
-	// For triggered state, send message and change arm status to avoid spamming, else just ping
-	if (g_state == sensortypes::state_triggered)
+	// Relays forward the messages of other sensors, and still sense on the
+	// wakes a sleeping sensor would have
+	if (g_relaying)
 	{
-		sendData(true);
-		changeArmStatus(false);
+		g_relay->poll();
+		if (!isRelayWakeDue())
+		{
+			return;
+		}
 	}
-	else
+
+	// Pick up the inputs that triggered while sleeping, a new event stays
+	// pending until it is delivered or the delivery policy gives up on it
+	if (g_inputs->getTriggeredMask() != 0)
+	{
+		g_state = sensortypes::state_triggered;
+		if (!g_delivery->isPending())
+		{
+			g_log->log(eventlog::event_trigger, g_inputs->getTriggeredMask());
+			g_delivery->start();
+			// The retry rounds of the event keep its sequence, so the hub can drop duplicates
+			g_message.sequence++;
+		}
+	}
+
+	// For triggered state, send the event, the triggered inputs stay disarmed until the ack of
+	// the next heartbeat to avoid spamming, else ping only if the state changed or the heartbeat
+	// interval expired
+	g_wakes_since_send++;
+	if (g_delivery->isPending())
+	{
+		sendEvent();
+	}
+	else if (g_state != g_reported_state || g_wakes_since_send >= g_heartbeat_wakes)
 	{
-		sendData(false);
+		g_message.sequence++;
+		sendData();
 	}
 
 	// Update the state to ping or battery low
 	updateSensorState();
 
-	// Sleep the mcu, with cycles determined by the armed state
-	mcuSleep();
-}
+	// Track how close the stack came to the heap
+	g_memory->update();
 
-// Blinks led given times
-void blinkLed(uint8_t times)
-{
-	for (uint8_t i = 0; i < times; i++)
+	// Sleep the mcu, with cycles determined by the armed state
+	if (!g_relaying)
 	{
-		delay(led_interval);
-		digitalWrite(led_pin, HIGH);
-		delay(led_interval);
-		digitalWrite(led_pin, LOW);
+		mcuSleep();
 	}
 }
 
@@ -140,22 +279,27 @@ void blinkLed(uint8_t times)
 // reinitializes the random seed based on the new sensor id.
 void bindSensor()
 {
+#ifdef DEBUG
 	Serial.println("Setup started");
+#endif
 
-	// Led stays lit during setup
-	digitalWrite(led_pin, HIGH);
+	// Led stays lit during setup, the hub takes join requests on the rendezvous channel
+	g_led->setLit(true);
+	g_channels->rendezvous();
 
 	bool isInstalled = g_setup->enterInstallMode();
 
 	// Led turns off after install
-	digitalWrite(led_pin, LOW);
+	g_led->setLit(false);
 
+#ifdef DEBUG
 	Serial.println("Setup ended");
+#endif
 
 	// If the install mode returns false (due to canceling), exit
 	if (!isInstalled)
 	{
-		blinkLed(setup_failed_blinks);
+		g_led->play(sensor::pattern_setup_failed);
 		return;
 	}
 
@@ -165,12 +309,12 @@ void bindSensor()
 	bool is_same_session_id = received_ids.session_id == g_message.session_id;
 	if (is_same_device_id && is_same_session_id)
 	{
-		g_setup->m_bind_response = sensor::setup_outcome_t::error;
-		blinkLed(setup_failed_blinks);
+		g_setup->completeInstall(sensor::setup_outcome_t::error);
+		g_led->play(sensor::pattern_setup_failed);
 		return;
 	}
 
-	g_setup->m_bind_response = sensor::setup_outcome_t::ok;
+	g_setup->completeInstall(sensor::setup_outcome_t::ok);
 
 	// Save ids to EEPROM
 	g_data->saveDeviceId(received_ids.parent_device_id);
@@ -185,79 +329,127 @@ void bindSensor()
 	// Reinitialize the seed with the new sensor id, now this seed is unique for this alarm system
 	randomSeed(g_message.sensor_id);
 
+	// Ping the new hub right away
+	g_wakes_since_send = g_heartbeat_wakes;
+
 	// Blink success
-	blinkLed(setup_success_blinks);
+	g_led->play(sensor::pattern_setup_success);
 #ifdef DEBUG
 	Serial.println("Saved Ids: " + String(g_message.parent_device_id) + ", " + String(g_message.session_id) + ", " + String(g_message.sensor_id));
 	Serial.flush();
 #endif
 }
 
-// Updates the global state based on the battery reading.
+// Receives a firmware image from the hub, the led stays lit during the transfer.
+// Returns only if the update failed, otherwise the sensor restarts into the bootloader.
+void updateFirmware()
+{
+#ifdef DEBUG
+	Serial.println("Firmware update started");
+	Serial.flush();
+#endif
+	g_log->flush();
+	g_led->setLit(true);
+	g_updater->update();
+	g_led->setLit(false);
+	g_led->play(sensor::pattern_setup_failed);
+}
+
+// Updates the global state based on the battery reading, the reading is logged
+// when the battery turns low or recovers.
 void updateSensorState()
 {
-	if (g_battery->isLow())
+	bool is_low = g_battery->isLow();
+	if (is_low != g_battery_low)
 	{
-		g_state = sensortypes::state_battery_low;
-	}
-	else
-	{
-		g_state = sensortypes::state_ping;
+		g_battery_low = is_low;
+		g_log->log(eventlog::event_battery, g_battery->getReading());
 	}
+	g_state = is_low ? sensortypes::state_battery_low : sensortypes::state_ping;
 }
 
-// Enables or disables the interrupt 0, based on the alarm arm state.
-void changeArmStatus(bool new_status)
+// Arms the inputs in the mask and disarms the rest.
+void changeArmStatus(uint8_t mask)
 {
-	if (new_status != g_is_armed)
+	if (mask != g_inputs->getArmedMask())
 	{
-		// If the alarm is armed
-		g_is_armed = new_status;
-		if (g_is_armed)
-		{
-			// Clear interrupt flag for pin D2
-			EIFR |= (1 << INT0);
-			// And attach an interrupt that sets state to triggered if movement is detected.
-			attachInterrupt(digitalPinToInterrupt(sensor_pin), sensorTriggerEvent, RISING);
-		}
-		else
-		{
-			// Else detach the interrupt.
-			detachInterrupt(0);
-		}
+		g_log->log(eventlog::event_armed, mask);
+		g_inputs->arm(mask);
 	}
 }
 
-// Is called only by the the interrupt, sets the state to triggered and detaches
-// the interrupt to prevent the firing of multiple interupts disrupting the program flow.
-void sensorTriggerEvent()
+// Returns true once a relay is due for the wake a sensor would have after its
+// sleep cycles, or at once for a new event. Uses the same cycles as mcuSleep.
+bool isRelayWakeDue()
 {
-	detachInterrupt(0);
-	g_state = sensortypes::state_triggered;
-#ifdef DEBUG
-	Serial.println("Trigger");
-	Serial.flush();
-#endif
+	uint32_t interval = 0;
+	if (g_delivery->isPending())
+	{
+		interval = g_delivery->getRetryDelay() * 1000UL;
+	}
+	else if (hasNewEvent())
+	{
+		interval = 0;
+	}
+	else if (g_inputs->getArmedMask() != 0)
+	{
+		interval = (uint32_t)g_config->get().sleep_cycles_armed * sensor::PowerManager::getPeriodMillis(sleep_cycle_armed);
+	}
+	else
+	{
+		interval = (uint32_t)sleep_cycles_disarmed * sensor::PowerManager::getPeriodMillis(sleep_cycle_disarmed);
+	}
+
+	// The first wake after boot is at once, like a sensor's
+	if (g_relay_wake_at != 0 && millis() - g_relay_wake_at < interval)
+	{
+		return false;
+	}
+	g_relay_wake_at = millis();
+	return true;
 }
 
 // Puts the mcu to a sleep cycle determined by the arm state. Shorter sleep cycles are selected
 // for armed state and longer for disarmed state.
 void mcuSleep()
 {
+	saveRetainedState();
 #ifdef DEBUG
 	Serial.flush();
 #endif
-	if (g_is_armed)
+	// Play the pending led pattern first, sleeping between its edges
+	while (g_led->isPlaying())
+	{
+		if (hasNewEvent() || g_setup->hasPendingSetup())
+		{
+			return;
+		}
+		g_led->sleepUntilNextEdge();
+	}
+
+	if (g_delivery->isPending())
+	{
+		// Wait for the next round of the pending event, the waits grow with every failed round
+		for (uint8_t i = 0; i < g_delivery->getRetryDelay(); i++)
+		{
+			if (g_setup->hasPendingSetup())
+			{
+				return;
+			}
+			g_power->powerDown(SLEEP_1S);
+		}
+	}
+	else if (g_inputs->getArmedMask() != 0)
 	{
 		// Shorter sleep cycles and sending in between if triggered
-		for (uint8_t i = 0; i < sleep_cycles_armed; i++)
+		for (uint8_t i = 0; i < g_config->get().sleep_cycles_armed; i++)
 		{
-			// If the interrupt triggered the state
-			if (g_state == sensortypes::state_triggered)
+			// If the interrupt triggered an input or the button was pressed
+			if (hasNewEvent() || g_setup->hasPendingSetup())
 			{
 				return;
 			}
-			LowPower.powerDown(sleep_cycle_armed, ADC_OFF, BOD_OFF);
+			g_power->powerDown(sleep_cycle_armed);
 		}
 	}
 	else
@@ -265,40 +457,139 @@ void mcuSleep()
 		// Long sleep cycles
 		for (uint8_t i = 0; i < sleep_cycles_disarmed; i++)
 		{
-			if (g_setup->getButtonPress())
+			// The button interrupt wakes the mcu from any cycle
+			if (g_setup->hasPendingSetup())
 			{
 				return;
 			}
-			LowPower.powerDown(sleep_cycle_disarmed, ADC_OFF, BOD_OFF);
+			g_power->powerDown(sleep_cycle_disarmed);
 		}
 	}
 }
 
-void sendData(bool hasNoTimeout)
+// Keeps the state needed to resume after a reset in the retained RAM.
+void saveRetainedState()
+{
+	sensor::RetainedData data;
+	data.parent_device_id = g_message.parent_device_id;
+	data.session_id = g_message.session_id;
+	data.sensor_id = g_message.sensor_id;
+	data.sequence = g_message.sequence;
+	data.armed_mask = g_inputs->getArmedMask();
+	data.triggered_mask = g_inputs->getTriggeredMask();
+	data.delivery_pending = g_delivery->isPending();
+	data.delivery_round = g_delivery->getRound();
+	data.delivery_elapsed = g_delivery->getElapsed();
+	data.delivery_writes = g_delivery->getWrites();
+	data.heartbeat_wakes = g_heartbeat_wakes;
+	data.channel = g_channels->getChannel();
+	g_retained->save(data);
+}
+
+// Returns true if an input triggered and its event is not yet being delivered.
+bool hasNewEvent()
+{
+	return g_inputs->getTriggeredMask() != 0 && !g_delivery->isPending();
+}
+
+// Runs one delivery round of the pending event. Once it is delivered or dropped,
+// the reported inputs are cleared, inputs triggered in between start a new event.
+void sendEvent()
+{
+	sendData();
+	g_delivery->onAttempt(g_radio->wasSent(), g_radio->getWrites());
+	if (g_delivery->wasDropped())
+	{
+		g_log->log(eventlog::event_dropped, g_message.inputs_triggered);
+	}
+	if (!g_delivery->isPending())
+	{
+		g_inputs->clearTriggered(g_message.inputs_triggered);
+	}
+}
+
+void sendData()
 {
 	// Update the state and send the message
 	g_message.state = (sensortypes::sensor_state_t)g_state;
-	sensortypes::SensorAck response = g_radio->send(g_message, hasNoTimeout);
+	g_message.inputs_triggered = g_inputs->getTriggeredMask();
+	uint16_t headroom = g_memory->getStackHeadroom() / 8;
+	g_message.stack_headroom = headroom > 255 ? 255 : headroom;
+	// A relay forwards the frames it holds first, sending drops them from the radio
+	if (g_relaying)
+	{
+		g_relay->poll();
+	}
+	sensortypes::SensorAck response = g_radio->send(g_message);
+	g_wakes_since_send = 0;
+	g_channels->onSend(g_radio->wasSent(), g_radio->getWrites());
+	if (g_radio->wasSent())
+	{
+		g_reported_state = g_message.state;
+	}
+	else
+	{
+		g_log->log(eventlog::event_send_failed, g_radio->getWrites());
+	}
 
-	// If the response is not empty and both the parent device id and session id match
-	if (!(response.parent_device_id == 0 && response.session_id == 0 && response.sensors_to_arm == 0) && response.parent_device_id == g_message.parent_device_id && response.session_id == g_message.session_id)
+	// If the response is not empty and both the parent device id and session id match.
+	// Only relays set the sensor id, as a relay may hand over the ack of another sensor.
+	bool is_own_ack = !g_radio->wasRelayed() || response.sensor_id == g_message.sensor_id;
+	if (!(response.parent_device_id == 0 && response.session_id == 0 && response.sensors_to_arm == 0) && response.parent_device_id == g_message.parent_device_id && response.session_id == g_message.session_id && is_own_ack)
 	{
 		// 0 since the types are either 1 or two, will disarm all sensors since 0 >= 1 or 2 is false in either case
 		// 1 will arm only the magnet sensors since 1 >= 1 or 2 is true for the magnet sensors (int 1)
 		// 2 will arm all sensors since 2 >= 1 or 2 is true for both types of sensors with id 1 and 2
-		if (response.sensors_to_arm >= g_message.type)
+		// The input mask then picks which of those inputs are armed. The inputs of an event
+		// stay out until the hub arms them again in the ack of a heartbeat.
+		if (g_message.inputs_triggered != 0)
 		{
-			changeArmStatus(true);
+			g_masked_inputs |= g_message.inputs_triggered;
 		}
 		else
 		{
-			changeArmStatus(false);
+			g_masked_inputs = 0;
+		}
+		changeArmStatus(response.inputs_to_arm & g_inputs->getTypeMask(response.sensors_to_arm) & ~g_masked_inputs);
+
+		// The hub may slow down idle sensors or speed up the ones it watches
+		if (response.heartbeat_wakes > 0)
+		{
+			g_heartbeat_wakes = response.heartbeat_wakes;
+		}
+
+		// Apply a newer configuration table, the version is reported back with every message
+		if (response.config_version != g_message.config_version && response.config[0] != sensortypes::config_end)
+		{
+			if (g_config->apply(response.config_version, response.config, sensortypes::config_table_size))
+			{
+				// Meet the hub on the rendezvous channel, which may have changed
+				g_channels->rendezvous();
+			}
+			g_message.config_version = g_config->get().version;
+		}
+
+		// Hop with the hub, relays stay on the rendezvous channel so relayed sensors stay there too
+		if (!g_radio->wasRelayed() && !g_relaying)
+		{
+			g_channels->follow(response.next_channel);
+		}
+
+		if (response.command == sensortypes::command_firmware_update)
+		{
+			updateFirmware();
 		}
 	}
 
 	// Blink for radio lost if not on setup mode (only one led)
 	if (!g_radio->wasSent() && !g_setup->m_setup)
 	{
-		blinkLed(signal_lost_blinks);
+		g_led->play(sensor::pattern_signal_lost);
+	}
+
+	// Sending left the relay address, listen again with the queued acks
+	if (g_relaying)
+	{
+		g_relay->resume();
 	}
 }
\ No newline at end of file
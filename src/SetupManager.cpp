@@ -1,14 +1,26 @@
 #include "SetupManager.h"
+#include "ChannelManager.h"
+#include "EventLog.h"
+#include "MemoryMonitor.h"
+#include "PowerManager.h"
+#include "RadioManager.h"
+#include "common/PinChange.h"
 #include "common/Timer.h"
 
+//#define DEBUG
+
 // Variables
 sensor::SetupManager *sensor::SetupManager::m_instance = nullptr;
 volatile char sensor::SetupManager::m_buffer[buffer_size] = {0};
 uint8_t sensor::SetupManager::m_request_response = 0;
 uint8_t sensor::SetupManager::m_receive_requests = 0;
-uint8_t sensor::SetupManager::m_bind_response = 0;
+volatile uint8_t sensor::SetupManager::m_bind_response = 0;
 bool sensor::SetupManager::m_setup = false;
 int sensor::SetupManager::m_button_pin = 0;
+volatile bool sensor::SetupManager::m_setup_requested = false;
+volatile bool sensor::SetupManager::m_button_armed = false;
+volatile uint8_t sensor::SetupManager::m_command = 0;
+volatile uint16_t sensor::SetupManager::m_dump_offset = 0;
 
 // Methods
 sensor::SetupManager *sensor::SetupManager::getInstance()
@@ -26,26 +38,47 @@ sensor::SetupManager::SetupManager()
 	// Attach the receive event to functions
 	Wire.onReceive(receiveEvent);
 	Wire.onRequest(requestEvent);
+	PinChange::attach(buttonEvent);
 }
 
 // Initliazes the pin mode for the install button and attaches the interrupt.
-// Additionally sets the request response.
-void sensor::SetupManager::init(uint8_t button_pin, uint8_t request_response)
+// Additionally sets the request response, the type sent with join requests and the
+// unconnected pin read for the join nonce.
+void sensor::SetupManager::init(uint8_t button_pin, uint8_t request_response, sensortypes::sensor_type_t type, uint8_t entropy_pin)
 {
+	m_type = type;
+	m_entropy_pin = entropy_pin;
+	m_source = source_cable;
 	m_button_pin = button_pin;
 	// Attach an interrupt to the setup button
 	pinMode(m_button_pin, INPUT);
+	rearmButton();
 	// Set the response bit, which is the type of the sensor
 	m_request_response = request_response;
 }
 
 // Enters the install mode, during which the sensor awaits for the ids to
 // be received, halting its operation until then, or until the button is pressed again.
+// The ids come from the cable or from a join response over the radio, whichever is first.
+// The I2C interface stays on after the ids are received, until completeInstall.
 bool sensor::SetupManager::enterInstallMode()
 {
 	Timer m_setup_timer(setup_timeout);
 	m_receive_requests = 0;
 	m_bind_response = 0;
+	m_source = source_cable;
+	// The nonce has to differ between sensors that join together. Unpaired sensors
+	// share the random seed, so it comes from the noise of the entropy pin instead,
+	// and also seeds the backoff after a response meant for another sensor.
+	uint32_t nonce = readEntropy();
+	randomSeed(nonce);
+	uint16_t join_delay = join_interval;
+	uint32_t last_join = millis() - join_delay;
+	m_command = 0;
+	// Write the batched events and scan the RAM, so the main device reads the latest ones
+	EventLog::getInstance()->flush();
+	MemoryMonitor::getInstance()->scan();
+	PowerManager::getInstance()->claim(domain_twi);
 	// Wire.begin needs to be called every time, as the sleep function
 	// deactivates the I2C pullup capacitors.
 	Wire.begin(address);
@@ -53,10 +86,28 @@ bool sensor::SetupManager::enterInstallMode()
 	// When the buffer is not empty then the receive loop takes control.
 	while (m_buffer[0] == 0)
 	{
-		// Escape if timeout
-		if (m_setup_timer.timeout())
+		// Ask the hub for the ids over the radio
+		if (millis() - last_join >= join_delay)
+		{
+			last_join = millis();
+			join_result_t result = requestJoin(nonce);
+			if (result == join_accepted)
+			{
+				break;
+			}
+			// The hub gave away the response of another sensor, back off for a random
+			// while so that sensor asks before this one takes its requeued response again
+			join_delay = result == join_foreign ? join_interval + random(join_interval * 3) : join_interval;
+		}
+
+		// Escape if timeout or if the button is pressed again
+		rearmButton();
+		if (m_setup_timer.timeout() || m_setup_requested)
 		{
+			m_setup_requested = false;
 			m_setup = false;
+			Wire.end();
+			PowerManager::getInstance()->release(domain_twi);
 			return false;
 		}
 	}
@@ -66,27 +117,119 @@ bool sensor::SetupManager::enterInstallMode()
 	return true;
 }
 
-// Returns true if the button is pressed
-bool sensor::SetupManager::getButtonPress()
+// Sends a join request and keeps the ids of a matching join response.
+sensor::join_result_t sensor::SetupManager::requestJoin(uint32_t nonce)
 {
-	return digitalRead(m_button_pin) == LOW;
+	sensortypes::JoinRequest request;
+	sensortypes::JoinResponse response;
+	request.nonce = nonce;
+	request.type = m_type;
+	if (!RadioManager::getInstance()->join(request, response))
+	{
+		return join_no_response;
+	}
+	if (response.nonce != nonce)
+	{
+		return join_foreign;
+	}
+
+	m_radio_ids.parent_device_id = response.parent_device_id;
+	m_radio_ids.session_id = response.session_id;
+	m_radio_ids.sensor_id = response.sensor_id;
+	m_source = source_radio;
+	return join_accepted;
 }
 
-// Returns true if the setup mode turns true,
-// when the button is pressed.
+// Mixes the lowest bits of the readings of the unconnected entropy pin with the
+// time since boot. The noise of a floating input differs from sensor to sensor.
+uint32_t sensor::SetupManager::readEntropy()
+{
+	uint32_t entropy = micros();
+	PowerManager::getInstance()->claim(domain_adc);
+	for (uint8_t i = 0; i < entropy_samples; i++)
+	{
+		entropy = (entropy << 3 | entropy >> 29) ^ analogRead(m_entropy_pin);
+	}
+	PowerManager::getInstance()->release(domain_adc);
+	return entropy ^ micros();
+}
+
+// Sets the outcome of the setup for the main device to read and waits until it
+// is read, or for a short timeout, before switching the I2C interface off.
+// Radio installs have no cable to read the outcome, so there is nothing to wait for.
+void sensor::SetupManager::completeInstall(setup_outcome_t outcome)
+{
+	Timer response_timer(bind_response_timeout);
+	m_bind_response = outcome;
+	while (m_source == source_cable && m_bind_response != 0 && !response_timer.timeout())
+	{
+	}
+	m_bind_response = 0;
+	Wire.end();
+	PowerManager::getInstance()->release(domain_twi);
+}
+
+// Returns true if the button was pressed and the press is not consumed yet,
+// lets the sleep loop wake up for it.
+bool sensor::SetupManager::hasPendingSetup()
+{
+	return m_setup_requested;
+}
+
+// Returns true if the setup mode turns true, consuming the pending button press.
 bool sensor::SetupManager::isSetup()
 {
-	bool button_pressed = digitalRead(m_button_pin) == LOW;
-	if (button_pressed)
+	rearmButton();
+	if (m_setup_requested)
 	{
-		m_setup = !m_setup;
+		m_setup_requested = false;
+		m_setup = true;
 	}
 	return m_setup;
 }
 
+// Re-enables the button interrupt once the button is released. The interrupt is
+// disabled from a press until then, and the button must read released for the whole
+// release time, which keeps the contact bounces of the release out.
+void sensor::SetupManager::rearmButton()
+{
+	if (m_button_armed)
+	{
+		return;
+	}
+
+	for (uint8_t i = 0; i < button_release_time; i++)
+	{
+		if (digitalRead(m_button_pin) == LOW)
+		{
+			return;
+		}
+		delay(1);
+	}
+	m_button_armed = true;
+	PinChange::enable(m_button_pin);
+}
+
+// Is called only by the pin change interrupt. Marks a press of the button as pending and
+// disables its interrupt, the bounces of the press and the release are then ignored.
+void sensor::SetupManager::buttonEvent()
+{
+	if (m_button_armed && digitalRead(m_button_pin) == LOW)
+	{
+		m_button_armed = false;
+		PinChange::disable(m_button_pin);
+		m_setup_requested = true;
+	}
+}
+
 // Returns the received ids and empties the buffer.
 sensor::ReceivedId sensor::SetupManager::getReceivedIds()
 {
+	if (m_source == source_radio)
+	{
+		return m_radio_ids;
+	}
+
 	// Intialize an empty object
 	ReceivedId received_ids;
 
@@ -156,14 +299,30 @@ sensor::ReceivedId sensor::SetupManager::getReceivedIds()
 	{
 		m_buffer[i] = 0;
 	}
+#ifdef DEBUG
 	Serial.println("Recevied Ids: " + String(received_ids.parent_device_id) + ", " + String(received_ids.session_id) + ", " + String(received_ids.sensor_id));
+#endif
 	return received_ids;
 }
 
 // On the receive event, red the I2C buffer char by char and transfer it to
-// the internal buffer.
+// the internal buffer. A single command byte selects what the next read requests return instead.
 void sensor::SetupManager::receiveEvent(int length)
 {
+	if (length == 1)
+	{
+		uint8_t command = Wire.read();
+		if (command == eventlog::dump_command || command == diagnostics::memory_command || command == diagnostics::channel_command)
+		{
+			m_dump_offset = 0;
+			m_command = command;
+			return;
+		}
+		m_buffer[0] = (char)command;
+		return;
+	}
+
+	m_command = 0;
 	uint8_t data_index = 0;
 	while (Wire.available())
 	{
@@ -172,12 +331,45 @@ void sensor::SetupManager::receiveEvent(int length)
 	}
 }
 
-// On the request event, respond with the device id.
+// On the request event, respond with the device id. While dumping the event log,
+// respond with its next bytes instead, as many as the I2C buffer holds.
+// After the memory or channel command, respond once with the matching report.
 void sensor::SetupManager::requestEvent()
 {
+	if (m_command == eventlog::dump_command)
+	{
+		uint8_t chunk[BUFFER_LENGTH];
+		uint8_t length = EventLog::getInstance()->readDump(m_dump_offset, chunk, BUFFER_LENGTH);
+		m_dump_offset += length;
+		if (length < BUFFER_LENGTH)
+		{
+			m_command = 0;
+		}
+		Wire.write(chunk, length);
+		return;
+	}
+
+	if (m_command == diagnostics::memory_command)
+	{
+		diagnostics::MemoryReport report = MemoryMonitor::getInstance()->getReport();
+		Wire.write((const uint8_t *)&report, sizeof(report));
+		m_command = 0;
+		return;
+	}
+
+	if (m_command == diagnostics::channel_command)
+	{
+		diagnostics::ChannelReport report = ChannelManager::getInstance()->getReport();
+		Wire.write((const uint8_t *)&report, sizeof(report));
+		m_command = 0;
+		return;
+	}
+
 	if (m_receive_requests == 0)
 	{
+#ifdef DEBUG
 		Serial.println("Sent:" + String(m_request_response));
+#endif
 
 		Wire.write(m_request_response);
 	}
@@ -185,7 +377,9 @@ void sensor::SetupManager::requestEvent()
 	{
 		if (m_bind_response > 0)
 		{
+#ifdef DEBUG
 			Serial.println("Sent:" + String(m_bind_response));
+#endif
 			Wire.write(m_bind_response);
 			// Set it to 0 to not be sent again
 			m_bind_response = 0;
@@ -1,7 +1,9 @@
 /*
-Handles the setup process after connecting the usb cable
-and pressing the setup button. Uses the I2C protocol to communicate
-via the usb cable and receive the main device's ids.
+Handles the setup process after pressing the setup button, which wakes the mcu
+through its pin change interrupt. The main device's ids are received either with
+the I2C protocol via the usb cable, or over the radio by sending join requests
+to the provisioning address. While in install mode, the main device can also
+read the event log and the diagnostics through the I2C interface.
 */
 
 #pragma once
@@ -13,6 +15,7 @@ via the usb cable and receive the main device's ids.
 #endif
 
 #include <Wire.h>
+#include "common/sensortypes.h"
 
 namespace sensor
 {
@@ -25,6 +28,14 @@ namespace sensor
 	// I2C communication address
 	const int address = 8;
 	const uint16_t setup_timeout = 15;
+	// Milliseconds between join requests over the radio
+	const uint16_t join_interval = 250;
+	// Analog readings of the floating entropy pin mixed into the join nonce
+	const uint8_t entropy_samples = 64;
+	// Milliseconds the button must read released before it is armed again
+	const uint8_t button_release_time = 20;
+	// Seconds the main device has to read the setup outcome
+	const uint16_t bind_response_timeout = 2;
 	// I2C receive buffer size, the number is derived from:
 	// Max device id: 4294967295 = 10 chars
 	// Max session id: 65535 = 5 chars
@@ -39,6 +50,21 @@ namespace sensor
 		uint8_t sensor_id = 0;
 	} ReceivedId;
 
+	// Outcome of a join request
+	typedef enum join_result_t
+	{
+		join_no_response = 0,
+		join_accepted = 1,
+		join_foreign = 2 // The ack carried the response of another sensor
+	} join_result_t;
+
+	// How the ids of the last install were received
+	typedef enum setup_source_t
+	{
+		source_cable = 0,
+		source_radio = 1
+	} setup_source_t;
+
 	class SetupManager
 	{
 	public:
@@ -47,10 +73,11 @@ namespace sensor
 		// Methods
 		static SetupManager *getInstance();
 		static bool m_setup;
-		static uint8_t m_bind_response;
-		void init(uint8_t button_pin, uint8_t request_response);
+		static volatile uint8_t m_bind_response;
+		void init(uint8_t button_pin, uint8_t request_response, sensortypes::sensor_type_t type, uint8_t entropy_pin);
 		bool enterInstallMode();
-		bool getButtonPress();
+		void completeInstall(setup_outcome_t outcome);
+		bool hasPendingSetup();
 		bool isSetup();
 		ReceivedId getReceivedIds();
 
@@ -59,11 +86,23 @@ namespace sensor
 		SetupManager();
 		static void receiveEvent(int length);
 		static void requestEvent();
+		static void buttonEvent();
+		void rearmButton();
+		join_result_t requestJoin(uint32_t nonce);
+		uint32_t readEntropy();
 		// Variables
 		static int m_button_pin;
+		static volatile bool m_setup_requested; // Set by the button interrupt, until consumed
+		static volatile bool m_button_armed;	// False from a press until the button is released
 		static uint8_t m_receive_requests;
 		static SetupManager *m_instance;
 		static volatile char m_buffer[buffer_size];
 		static uint8_t m_request_response;
+		static volatile uint8_t m_command;		// I2C command the read requests answer, 0 for none
+		static volatile uint16_t m_dump_offset; // Next byte of the event log dump
+		sensortypes::sensor_type_t m_type;
+		uint8_t m_entropy_pin; // Unconnected analog pin, its noise seeds the join nonce
+		setup_source_t m_source;
+		ReceivedId m_radio_ids;
 	};
 } //  namespace sensor
\ No newline at end of file
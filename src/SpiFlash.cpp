@@ -0,0 +1,140 @@
+#include "SpiFlash.h"
+#include "PowerManager.h"
+
+// Flash commands
+const uint8_t flash_write_enable = 0x06;
+const uint8_t flash_read_status = 0x05;
+const uint8_t flash_page_program = 0x02;
+const uint8_t flash_sector_erase = 0x20;
+const uint8_t flash_read_data = 0x03;
+const uint8_t flash_power_down = 0xB9;
+const uint8_t flash_release_power_down = 0xAB;
+const uint8_t flash_status_busy = 0x01;
+
+sensor::SpiFlash *sensor::SpiFlash::m_instance = nullptr;
+
+sensor::SpiFlash *sensor::SpiFlash::getInstance()
+{
+	if (m_instance == nullptr)
+	{
+		m_instance = new SpiFlash();
+	}
+	return m_instance;
+}
+
+sensor::SpiFlash::SpiFlash() {}
+
+// Sets the chip select pin and puts the flash in deep power down,
+// it shares the SPI bus with the radio.
+void sensor::SpiFlash::init(uint8_t cs_pin)
+{
+	m_cs_pin = cs_pin;
+	pinMode(m_cs_pin, OUTPUT);
+	digitalWrite(m_cs_pin, HIGH);
+	SPI.begin();
+	sleep();
+}
+
+// Releases the flash from deep power down.
+void sensor::SpiFlash::wake()
+{
+	command(flash_release_power_down);
+	// The flash needs a few microseconds before accepting commands
+	delayMicroseconds(50);
+}
+
+// Puts the flash in deep power down, where it draws about a microamp.
+void sensor::SpiFlash::sleep()
+{
+	command(flash_power_down);
+}
+
+// Erases the 4K sectors that cover the given range.
+void sensor::SpiFlash::eraseSectors(uint32_t address, uint32_t length)
+{
+	uint32_t end = address + length;
+	for (uint32_t sector = address - (address % flash_sector_size); sector < end; sector += flash_sector_size)
+	{
+		command(flash_write_enable);
+		commandAddress(flash_sector_erase, sector);
+		unselect();
+		waitReady();
+	}
+}
+
+// Writes the data, splitting it so no program command crosses a page boundary.
+void sensor::SpiFlash::write(uint32_t address, const uint8_t *data, uint16_t length)
+{
+	while (length > 0)
+	{
+		uint16_t page_left = flash_page_size - (address % flash_page_size);
+		uint16_t count = length < page_left ? length : page_left;
+
+		command(flash_write_enable);
+		commandAddress(flash_page_program, address);
+		for (uint16_t i = 0; i < count; i++)
+		{
+			SPI.transfer(data[i]);
+		}
+		unselect();
+		waitReady();
+
+		address += count;
+		data += count;
+		length -= count;
+	}
+}
+
+// Reads the given number of bytes starting at the address.
+void sensor::SpiFlash::read(uint32_t address, uint8_t *data, uint16_t length)
+{
+	commandAddress(flash_read_data, address);
+	for (uint16_t i = 0; i < length; i++)
+	{
+		data[i] = SPI.transfer(0);
+	}
+	unselect();
+}
+
+void sensor::SpiFlash::select()
+{
+	PowerManager::getInstance()->claim(domain_spi);
+	SPI.beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+	digitalWrite(m_cs_pin, LOW);
+}
+
+void sensor::SpiFlash::unselect()
+{
+	digitalWrite(m_cs_pin, HIGH);
+	SPI.endTransaction();
+	PowerManager::getInstance()->release(domain_spi);
+}
+
+// Sends a single byte command.
+void sensor::SpiFlash::command(uint8_t command)
+{
+	select();
+	SPI.transfer(command);
+	unselect();
+}
+
+// Sends a command followed by a 24 bit address and leaves the chip selected.
+void sensor::SpiFlash::commandAddress(uint8_t command, uint32_t address)
+{
+	select();
+	SPI.transfer(command);
+	SPI.transfer(address >> 16);
+	SPI.transfer(address >> 8);
+	SPI.transfer(address);
+}
+
+// Polls the status register until the last program or erase is done.
+void sensor::SpiFlash::waitReady()
+{
+	select();
+	SPI.transfer(flash_read_status);
+	while (SPI.transfer(0) & flash_status_busy)
+	{
+	}
+	unselect();
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+A minimal driver for the external SPI NOR flash that stages firmware images.
+Only the commands needed for staging are implemented, they are common to the
+Winbond W25X and Atmel AT25DF parts used with the DualOptiboot bootloader.
+*/
+
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <SPI.h>
+
+namespace sensor
+{
+	// Flash geometry
+	const uint16_t flash_page_size = 256;
+	const uint16_t flash_sector_size = 4096;
+
+	class SpiFlash
+	{
+	public:
+		SpiFlash(SpiFlash const &) = delete;
+		void operator=(SpiFlash const &) = delete;
+		// Methods
+		static SpiFlash *getInstance();
+		void init(uint8_t cs_pin);
+		void wake();
+		void sleep();
+		void eraseSectors(uint32_t address, uint32_t length);
+		void write(uint32_t address, const uint8_t *data, uint16_t length);
+		void read(uint32_t address, uint8_t *data, uint16_t length);
+
+	private:
+		// Methods
+		SpiFlash();
+		void select();
+		void unselect();
+		void command(uint8_t command);
+		void commandAddress(uint8_t command, uint32_t address);
+		void waitReady();
+		// Variables
+		static SpiFlash *m_instance;
+		uint8_t m_cs_pin;
+	};
+} // namespace sensor
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "PinChange.h"
+
+void (*PinChange::m_handlers[max_pin_change_handlers])() = {nullptr};
+uint8_t PinChange::m_handler_count = 0;
+
+//Adds a handler that is called on every pin change.
+void PinChange::attach(void (*handler)()) {
+	if (m_handler_count < max_pin_change_handlers) {
+		m_handlers[m_handler_count++] = handler;
+	}
+}
+
+//Enables the interrupt of the pin and its group, clearing a stale
+//flag of the group first.
+void PinChange::enable(uint8_t pin) {
+	PCIFR |= bit(digitalPinToPCICRbit(pin));
+	*digitalPinToPCMSK(pin) |= bit(digitalPinToPCMSKbit(pin));
+	*digitalPinToPCICR(pin) |= bit(digitalPinToPCICRbit(pin));
+}
+
+//Disables the interrupt of the pin, the group stays enabled for the others.
+void PinChange::disable(uint8_t pin) {
+	*digitalPinToPCMSK(pin) &= ~bit(digitalPinToPCMSKbit(pin));
+}
+
+//Calls every attached handler.
+void PinChange::dispatch() {
+	for (uint8_t i = 0; i < m_handler_count; i++) {
+		m_handlers[i]();
+	}
+}
+
+//All the pin change groups share the same handlers
+ISR(PCINT0_vect) {
+	PinChange::dispatch();
+}
+
+ISR(PCINT1_vect) {
+	PinChange::dispatch();
+}
+
+ISR(PCINT2_vect) {
+	PinChange::dispatch();
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+/*
+Shares the pin change interrupts between the classes that watch pins. The
+interrupts of all the pin groups call every attached handler, which then
+checks its own pins.
+*/
+#pragma once
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include "arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+const uint8_t max_pin_change_handlers = 2;
+
+class PinChange {
+public:
+	static void attach(void (*handler)());
+	static void enable(uint8_t pin);
+	static void disable(uint8_t pin);
+	static void dispatch();
+
+private:
+	//Variables
+	static void (*m_handlers[max_pin_change_handlers])();
+	static uint8_t m_handler_count;
+};
\ No newline at end of file
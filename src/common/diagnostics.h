@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+// Runtime diagnostics the hub reads over I2C in install mode. The hub writes the
+// command byte, the next read request returns the report with its little endian
+// fields in declaration order.
+namespace diagnostics
+{
+	const uint8_t memory_command = 0xD1;
+	const uint8_t channel_command = 0xD2;
+	// Channels in the channel report
+	const uint8_t report_channels = 4;
+
+	// RAM use of the sensor, see MemoryMonitor.h
+	typedef struct MemoryReport
+	{
+		uint16_t free_ram = 0;		 // Bytes between the heap and the stack when the report was made
+		uint16_t stack_headroom = 0; // Bytes the heap and the stack never used since boot
+	} MemoryReport;
+
+	// Delivery statistics of a channel since boot, see ChannelManager.h
+	typedef struct ChannelStats
+	{
+		uint8_t channel = 0;
+		uint16_t messages = 0;	// Messages sent on the channel
+		uint16_t delivered = 0; // Messages the hub acked
+		uint16_t writes = 0;	// Radio writes spent on the messages
+	} ChannelStats;
+
+	// Statistics of the channels the sensor used, the first count entries are valid
+	typedef struct ChannelReport
+	{
+		uint8_t count = 0;
+		ChannelStats channels[report_channels];
+	} ChannelReport;
+} // namespace diagnostics
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+// Ring log of recent events, kept in the EEPROM by the sensor firmware and read
+// back over I2C in install mode. The hub writes the dump command, then every read
+// request returns the next bytes of the dump: the dump magic, the record size and
+// the record count, followed by the records from the oldest, each with the little
+// endian fields of LogRecord in declaration order. tools/eventlog decodes a dump.
+namespace eventlog
+{
+	const uint8_t dump_command = 0xD0;
+	const uint8_t dump_magic = 0xE7;
+	const uint8_t dump_header_size = 3;
+	const uint8_t log_record_size = 8;
+
+	// Events of the log, the value of the record depends on the event.
+	typedef enum log_event_t
+	{
+		event_reset = 1,	   // Value is the reset cause, the MCUSR flags the bootloader passed on
+		event_trigger = 2,	   // Value is the mask of the triggered inputs
+		event_send_failed = 3, // Value is the writes spent on the message
+		event_dropped = 4,	   // Value is the mask of the inputs of the dropped event
+		event_battery = 5,	   // Value is the analog reading of the battery
+		event_armed = 6,	   // Value is the mask of the armed inputs
+		event_channel = 7,	   // Value is the channel the sensor moved to
+		event_empty = 0xFF	   // Erased record
+	} log_event_t;
+
+	typedef struct LogRecord
+	{
+		uint8_t sequence = 0; // Increments with every record, marks the end of the ring
+		uint8_t event = event_empty;
+		uint16_t value = 0;
+		uint32_t time = 0; // Seconds since boot, including the time asleep
+	} LogRecord;
+} // namespace eventlog
\ No newline at end of file
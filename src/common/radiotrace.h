@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+// Binary trace of the radio frames, written to the serial port when RADIO_TRACE is
+// defined in RadioManager.cpp and read back by tools/radiotrace. Every record is the
+// sync byte, the little endian fields of TraceRecord in declaration order, the raw
+// frame and a checksum byte, the xor of everything after the sync byte. The checksum
+// lets the reader skip any debug text mixed into the same capture.
+namespace radiotrace
+{
+	const uint8_t trace_sync = 0xA5;
+	// Size of the fields after the sync byte, without the frame
+	const uint8_t trace_record_size = 12;
+	const uint8_t trace_max_frame = 32;
+
+	// Direction of a traced frame.
+	typedef enum trace_direction_t
+	{
+		direction_tx = 0,  // Frame written by the sensor
+		direction_ack = 1, // Ack payload received with a written frame
+		direction_rx = 2   // Frame received while listening
+	} trace_direction_t;
+
+	// Flags of a traced frame.
+	typedef enum trace_flag_t
+	{
+		flag_delivered = 1 // The frame was acked by the receiver
+	} trace_flag_t;
+
+	typedef struct TraceRecord
+	{
+		uint32_t timestamp = 0; // Milliseconds since boot
+		uint8_t direction = direction_tx;
+		uint8_t flags = 0;
+		uint8_t retries = 0;   // Writes that were not acked before this one
+		uint8_t arc = 0;	   // Auto retransmissions of the last write
+		uint8_t pa_level = 0;  // nRF24 power amplifier level
+		uint8_t data_rate = 0; // nRF24 data rate, 0 is 1Mbps, 1 is 2Mbps and 2 is 250Kbps
+		uint8_t channel = 0;
+		uint8_t length = 0; // Length of the frame that follows
+	} TraceRecord;
+} // namespace radiotrace
\ No newline at end of file
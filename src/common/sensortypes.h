@@ -1,13 +1,17 @@
 #pragma once
 
+#include <stdint.h>
+
 namespace sensortypes
 {
-	// Represents the type of the sensor (magnet or PIR)
+	// Represents the type of the sensor (magnet or PIR), tamper inputs
+	// are armed by the input mask alone.
 	typedef enum sensor_type_t
 	{
 		type_none = 0,
 		type_magnet = 1,
-		type_pir = 2
+		type_pir = 2,
+		type_tamper = 3
 	} sensor_t;
 
 	// States of a sensor.
@@ -18,6 +22,107 @@ namespace sensortypes
 		state_battery_low = 2
 	} sensor_state_t;
 
+	// Tags of the configuration entries pushed in the ack payload. Each entry is
+	// encoded as tag, length and a little endian value, a zero tag ends the table.
+	typedef enum config_tag_t
+	{
+		config_end = 0,
+		config_battery_threshold = 1, // uint16_t
+		config_sleep_cycles_armed = 2, // uint8_t
+		config_led_interval = 3,	   // uint16_t
+		config_max_retries = 4,		   // uint8_t
+		config_min_delay = 5,		   // uint16_t
+		config_max_delay = 6,		   // uint16_t
+		config_channel = 7,			   // uint8_t
+		config_hop_channels = 8,	   // uint8_t list, up to max_hop_channels, empty stops hopping
+		config_relay = 9			   // uint8_t, 1 if a relay serves the sensor
+	} config_tag_t;
+
+	// Size of the configuration table in the ack, keeps the ack within the 32 byte payload.
+	const uint8_t config_table_size = 12;
+	// Channels the hub may hop to besides the rendezvous channel.
+	const uint8_t max_hop_channels = 4;
+
+	// Thresholds and timings that can be changed remotely.
+	typedef struct SensorConfig
+	{
+		uint8_t version = 0;
+		uint16_t battery_voltage_threshold = 0;
+		uint8_t sleep_cycles_armed = 0;
+		uint16_t led_interval = 0;
+		uint8_t max_retries = 0;
+		uint16_t min_delay = 0;
+		uint16_t max_delay = 0;
+		uint8_t channel = 0;
+		uint8_t hop_channels[max_hop_channels] = {0}; // Unused entries are 0
+		uint8_t relay = 0;							  // 1 if the relay route may be tried
+	} SensorConfig;
+
+	// Commands the hub can give in the ack payload.
+	typedef enum command_t
+	{
+		command_none = 0,
+		command_firmware_update = 1
+	} command_t;
+
+	// Firmware images are streamed in chunks that fill a whole payload and are
+	// acknowledged in windows, index firmware_header_index carries the FirmwareHeader.
+	const uint8_t firmware_chunk_size = 30;
+	const uint8_t firmware_window_size = 8;
+	const uint16_t firmware_header_index = 0xFFFF;
+
+	// Status reported in the window acks of a firmware update.
+	typedef enum firmware_status_t
+	{
+		firmware_receiving = 0,
+		firmware_verified = 1,
+		firmware_failed = 2
+	} firmware_status_t;
+
+	// Describes the image that follows, the crc is CRC-16/XMODEM over the whole image.
+	typedef struct FirmwareHeader
+	{
+		uint16_t image_size = 0;
+		uint16_t chunk_count = 0;
+		uint16_t crc = 0;
+	} FirmwareHeader;
+
+	// A chunk of the firmware image, sent by the hub to the reading pipe.
+	typedef struct FirmwareChunk
+	{
+		uint16_t index = 0;
+		uint8_t data[firmware_chunk_size] = {0};
+	} FirmwareChunk;
+
+	// Sent by the sensor after each window, a set bit means the chunk base + bit was stored.
+	typedef struct FirmwareWindowAck
+	{
+		uint16_t base = 0;
+		uint8_t received = 0;
+		uint8_t status = firmware_receiving;
+	} FirmwareWindowAck;
+
+	// Sent by a sensor in install mode to the provisioning address. The nonce is random
+	// for every install, so the hub can tell apart sensors that join at the same time.
+	typedef struct JoinRequest
+	{
+		uint32_t nonce = 0;
+		sensor_type_t type = type_none;
+	} JoinRequest;
+
+	// Ack payload of a join request. The hub queues one response per pending nonce and the
+	// sensor repeats its request until the ack carries its own nonce. The radio hands an
+	// ack payload to whichever sensor writes next, so the hub requeues a response until its
+	// sensor sends the first message with the new ids, and a sensor that receives another
+	// nonce backs off to let the owner ask first.
+	typedef struct JoinResponse
+	{
+		uint32_t nonce = 0;
+		uint32_t parent_device_id = 0;
+		uint16_t session_id = 0;
+		uint8_t sensor_id = 0;
+	} JoinResponse;
+
 	// Wrapper for received sensor messages.
 	typedef struct SensorMessage
 	{
@@ -26,13 +131,33 @@ namespace sensortypes
 		uint8_t sensor_id = 0;			   // Will only go up to 6, which is the max sensors.
 		sensor_type_t type = type_none;	   // Type of the sensor.
 		sensor_state_t state = state_ping; // The state of the sensor.
+		uint8_t config_version = 0;		   // Version of the configuration the sensor runs.
+		uint8_t inputs_triggered = 0;	   // Bitmask of the inputs that triggered.
+		uint8_t sequence = 0;			   // Sequence number of the message, the retry rounds of an event repeat it.
+		uint8_t hops = 0;				   // Relays the message went through.
+		uint8_t stack_headroom = 0;		   // RAM never used since boot, in 8 byte units up to 255.
 	} SensorMessage;
 
+	// Size of a SensorMessage on the avr, where the tools recognize it by. The avr
+	// build checks it, so it cannot go stale when the message changes.
+	const uint8_t sensor_message_size = 16;
+#ifdef __AVR__
+	static_assert(sizeof(SensorMessage) == sensor_message_size, "sensor_message_size must match SensorMessage");
+#endif
+
 	//Wrapper for the sensor ack.
 	typedef struct SensorAck
 	{
 		uint32_t parent_device_id = 0;			  //Parent is this device, up to 4billion.
 		uint16_t session_id = 0;				  //Session that its id was given, up to 128k.
 		sensor_type_t sensors_to_arm = type_none; //The sensor types to arm
+		uint8_t heartbeat_wakes = 0;			  //Wakes between heartbeat pings, 0 keeps the current interval.
+		uint8_t config_version = 0;				  //Version of the pushed configuration table.
+		uint8_t config[config_table_size] = {0};  //Configuration entries, see config_tag_t.
+		uint8_t inputs_to_arm = 0;				  //Bitmask of the inputs to arm, filtered by sensors_to_arm.
+		uint8_t command = command_none;			  //Command to run after this ack, see command_t.
+		uint8_t sensor_id = 0;					  //Sensor the ack is for, relays queue acks of several sensors.
+		uint8_t sequence = 0;					  //Sequence of the message the ack is for, set by relays.
+		uint8_t next_channel = 0;				  //Channel the hub hops to, 0 stays on the current one.
 	} SensorAck;
 }
\ No newline at end of file
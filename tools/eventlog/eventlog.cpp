@@ -0,0 +1,127 @@
+/*
+Decodes an event log dump read from a sensor over I2C in install mode (see
+src/common/eventlog.h) and prints its records from the oldest.
+
+Build: g++ -std=c++11 -O2 -o eventlog eventlog.cpp
+
+Usage: eventlog <dump>
+
+The dump is the raw bytes returned by the read requests after the dump
+command, padding after the last record is ignored.
+*/
+
+#include "../../src/common/eventlog.h"
+
+#include <stdio.h>
+#include <vector>
+
+static uint32_t readLittleEndian(const uint8_t *bytes, uint8_t length)
+{
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < length; i++)
+	{
+		value |= (uint32_t)bytes[i] << (8 * i);
+	}
+	return value;
+}
+
+static const char *eventName(uint8_t event)
+{
+	switch (event)
+	{
+	case eventlog::event_reset:
+		return "reset";
+	case eventlog::event_trigger:
+		return "trigger";
+	case eventlog::event_send_failed:
+		return "send_failed";
+	case eventlog::event_dropped:
+		return "dropped";
+	case eventlog::event_battery:
+		return "battery";
+	case eventlog::event_armed:
+		return "armed";
+	case eventlog::event_channel:
+		return "channel";
+	default:
+		return "unknown";
+	}
+}
+
+// Describes the value of the record, its meaning depends on the event.
+static void printValue(uint8_t event, uint16_t value)
+{
+	switch (event)
+	{
+	case eventlog::event_reset:
+		// MCUSR flags of the ATmega328
+		printf("%s%s%s%s", value & 0x01 ? "power-on " : "", value & 0x02 ? "external " : "", value & 0x04 ? "brown-out " : "", value & 0x08 ? "watchdog " : "");
+		break;
+	case eventlog::event_trigger:
+	case eventlog::event_dropped:
+	case eventlog::event_armed:
+		printf("inputs 0x%02x", value);
+		break;
+	case eventlog::event_send_failed:
+		printf("%u writes", value);
+		break;
+	case eventlog::event_battery:
+		printf("reading %u", value);
+		break;
+	case eventlog::event_channel:
+		printf("channel %u", value);
+		break;
+	default:
+		printf("%u", value);
+		break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <dump>\n", argv[0]);
+		return 2;
+	}
+
+	FILE *input = fopen(argv[1], "rb");
+	if (input == nullptr)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	std::vector<uint8_t> dump;
+	int byte;
+	while ((byte = fgetc(input)) != EOF)
+	{
+		dump.push_back((uint8_t)byte);
+	}
+	fclose(input);
+
+	if (dump.size() < eventlog::dump_header_size || dump[0] != eventlog::dump_magic || dump[1] != eventlog::log_record_size)
+	{
+		fprintf(stderr, "%s: not an event log dump\n", argv[1]);
+		return 1;
+	}
+
+	uint8_t count = dump[2];
+	size_t expected = eventlog::dump_header_size + (size_t)count * eventlog::log_record_size;
+	if (dump.size() < expected)
+	{
+		fprintf(stderr, "%s: truncated, %zu of %zu bytes\n", argv[1], dump.size(), expected);
+		count = (dump.size() - eventlog::dump_header_size) / eventlog::log_record_size;
+	}
+
+	printf("%u records\n\n", count);
+	printf("%-4s %10s  %-12s %s\n", "seq", "time_s", "event", "value");
+	for (uint8_t i = 0; i < count; i++)
+	{
+		const uint8_t *record = dump.data() + eventlog::dump_header_size + i * eventlog::log_record_size;
+		uint8_t event = record[1];
+		printf("%-4u %10u  %-12s ", record[0], readLittleEndian(record + 4, 4), eventName(event));
+		printValue(event, readLittleEndian(record + 2, 2));
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,259 @@
+/*
+Reads the binary radio traces written by the sensor firmware (see
+src/common/radiotrace.h) and either prints per sensor delivery statistics or
+replays the sensor messages of a capture into a gateway under test.
+
+Build: g++ -std=c++11 -O2 -o radiotrace radiotrace.cpp
+
+Usage: radiotrace stats <capture>
+       radiotrace replay <capture> [output]
+
+Captures are memory mapped, so very large ones are streamed by the kernel.
+Replay writes every traced sensor message as a length byte followed by the
+raw frame, to the output file, fifo or the standard output.
+*/
+
+#include "../../src/common/radiotrace.h"
+#include "../../src/common/sensortypes.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <map>
+#include <tuple>
+
+// Size of a sensor message frame, other frames are not sensor messages
+const uint8_t message_size = sensortypes::sensor_message_size;
+// Auto retransmissions the radio does for each write, nrf24_retransmit_count in src/Nrf24.h
+const uint8_t auto_retransmits = 15;
+// Retries above this are counted in the last bucket of the distribution
+const uint8_t max_retry_bucket = 16;
+
+// A decoded trace record and a pointer to its frame inside the mapped capture.
+struct Record
+{
+	radiotrace::TraceRecord header;
+	const uint8_t *frame;
+};
+
+// Identifies a sensor by the ids of its messages.
+typedef std::tuple<uint32_t, uint16_t, uint8_t> SensorKey;
+
+struct SensorStats
+{
+	uint32_t messages = 0;
+	uint32_t delivered = 0;
+	uint32_t acks = 0;
+	double airtime_us = 0;
+};
+
+static uint32_t readLittleEndian(const uint8_t *bytes, uint8_t length)
+{
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < length; i++)
+	{
+		value |= (uint32_t)bytes[i] << (8 * i);
+	}
+	return value;
+}
+
+// Decodes the record at the position, returns its total size or 0 if there is no valid record there.
+static size_t parseRecord(const uint8_t *data, size_t left, Record &record)
+{
+	const size_t overhead = 1 + radiotrace::trace_record_size + 1;
+	if (left < overhead || data[0] != radiotrace::trace_sync)
+	{
+		return 0;
+	}
+
+	const uint8_t *fields = data + 1;
+	uint8_t length = fields[11];
+	if (length > radiotrace::trace_max_frame || left < overhead + length)
+	{
+		return 0;
+	}
+
+	uint8_t checksum = 0;
+	for (size_t i = 0; i < (size_t)radiotrace::trace_record_size + length; i++)
+	{
+		checksum ^= fields[i];
+	}
+	if (checksum != fields[radiotrace::trace_record_size + length])
+	{
+		return 0;
+	}
+
+	record.header.timestamp = readLittleEndian(fields, 4);
+	record.header.direction = fields[4];
+	record.header.flags = fields[5];
+	record.header.retries = fields[6];
+	record.header.arc = fields[7];
+	record.header.pa_level = fields[8];
+	record.header.data_rate = fields[9];
+	record.header.channel = fields[10];
+	record.header.length = length;
+	record.frame = fields + radiotrace::trace_record_size;
+	return overhead + length;
+}
+
+// Calls the visitor for every valid record, skipping bytes that are not part of one.
+template <typename Visitor>
+static void forEachRecord(const uint8_t *data, size_t size, Visitor visit)
+{
+	size_t position = 0;
+	Record record;
+	while (position < size)
+	{
+		size_t record_size = parseRecord(data + position, size - position, record);
+		if (record_size == 0)
+		{
+			position++;
+			continue;
+		}
+		visit(record);
+		position += record_size;
+	}
+}
+
+// Time on air of one enhanced shockburst packet carrying the frame, in microseconds.
+static double packetAirtime(uint8_t length, uint8_t data_rate)
+{
+	// Preamble, 5 byte address, 9 bit control field, payload and 2 byte crc
+	double bits = 8.0 * (1 + 5 + length + 2) + 9;
+	double bits_per_us = data_rate == 1 ? 2.0 : (data_rate == 2 ? 0.25 : 1.0);
+	return bits / bits_per_us;
+}
+
+static SensorKey sensorKey(const uint8_t *frame)
+{
+	return SensorKey(readLittleEndian(frame, 4), readLittleEndian(frame + 4, 2), frame[6]);
+}
+
+static int printStats(const uint8_t *data, size_t size)
+{
+	std::map<SensorKey, SensorStats> sensors;
+	uint32_t retries[max_retry_bucket + 1] = {0};
+	SensorKey last_sensor;
+	bool has_last_sensor = false;
+	uint32_t records = 0;
+
+	forEachRecord(data, size, [&](const Record &record) {
+		records++;
+		const radiotrace::TraceRecord &header = record.header;
+		if (header.direction == radiotrace::direction_ack && has_last_sensor)
+		{
+			sensors[last_sensor].acks++;
+			return;
+		}
+		if (header.direction != radiotrace::direction_tx || header.length != message_size)
+		{
+			has_last_sensor = false;
+			return;
+		}
+
+		last_sensor = sensorKey(record.frame);
+		has_last_sensor = true;
+		SensorStats &stats = sensors[last_sensor];
+		stats.messages++;
+		bool is_delivered = header.flags & radiotrace::flag_delivered;
+		if (is_delivered)
+		{
+			stats.delivered++;
+		}
+
+		// Every unacked write used all the auto retransmissions, the last one only the counted ones
+		uint32_t packets = header.retries * (auto_retransmits + 1) + (is_delivered ? header.arc + 1 : 0);
+		stats.airtime_us += packets * packetAirtime(header.length, header.data_rate);
+		retries[header.retries < max_retry_bucket ? header.retries : max_retry_bucket]++;
+	});
+
+	printf("%u records, %zu sensors\n\n", records, sensors.size());
+	printf("%-12s %-8s %-6s %10s %10s %8s %8s %12s\n", "device", "session", "sensor", "messages", "delivered", "ratio", "acks", "airtime_ms");
+	for (const auto &entry : sensors)
+	{
+		const SensorStats &stats = entry.second;
+		printf("%-12u %-8u %-6u %10u %10u %8.3f %8u %12.3f\n", std::get<0>(entry.first), std::get<1>(entry.first), std::get<2>(entry.first),
+			   stats.messages, stats.delivered, stats.messages ? (double)stats.delivered / stats.messages : 0.0, stats.acks, stats.airtime_us / 1000.0);
+	}
+
+	printf("\nretries  messages\n");
+	for (uint8_t i = 0; i <= max_retry_bucket; i++)
+	{
+		if (retries[i] > 0)
+		{
+			printf("%s%-6u %9u\n", i == max_retry_bucket ? ">=" : "  ", i, retries[i]);
+		}
+	}
+	return 0;
+}
+
+static int replay(const uint8_t *data, size_t size, const char *output_path)
+{
+	FILE *output = output_path ? fopen(output_path, "wb") : stdout;
+	if (output == nullptr)
+	{
+		perror(output_path);
+		return 1;
+	}
+
+	uint32_t frames = 0;
+	forEachRecord(data, size, [&](const Record &record) {
+		if (record.header.direction != radiotrace::direction_tx || record.header.length != message_size)
+		{
+			return;
+		}
+		fputc(record.header.length, output);
+		fwrite(record.frame, 1, record.header.length, output);
+		frames++;
+	});
+
+	if (output != stdout)
+	{
+		fclose(output);
+	}
+	fprintf(stderr, "%u frames replayed\n", frames);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3 || (strcmp(argv[1], "stats") != 0 && strcmp(argv[1], "replay") != 0))
+	{
+		fprintf(stderr, "Usage: %s stats <capture>\n       %s replay <capture> [output]\n", argv[0], argv[0]);
+		return 2;
+	}
+
+	int file = open(argv[2], O_RDONLY);
+	struct stat file_stat;
+	if (file < 0 || fstat(file, &file_stat) < 0)
+	{
+		perror(argv[2]);
+		return 1;
+	}
+
+	size_t size = file_stat.st_size;
+	const uint8_t *data = nullptr;
+	if (size > 0)
+	{
+		void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapped == MAP_FAILED)
+		{
+			perror("mmap");
+			return 1;
+		}
+		madvise(mapped, size, MADV_SEQUENTIAL);
+		data = (const uint8_t *)mapped;
+	}
+
+	int result = strcmp(argv[1], "stats") == 0 ? printStats(data, size) : replay(data, size, argc > 3 ? argv[3] : nullptr);
+
+	if (data != nullptr)
+	{
+		munmap((void *)data, size);
+	}
+	close(file);
+	return result;
+}